@@ -7,10 +7,261 @@
 
 #define MAXLINE         80
 
+/*
+ * syscall numbers for the phase 4 calls that usyscall.h doesn't define;
+ * these start above its numbers and stay below MAXSYSCALLS
+ */
+#define SYS_DISKREADASYNC    30
+#define SYS_DISKWRITEASYNC   31
+#define SYS_DISKWAIT         32
+#define SYS_DISKREADV        33
+#define SYS_DISKWRITEV       34
+#define SYS_DISKREADBLOCKS   35
+#define SYS_DISKWRITEBLOCKS  36
+#define SYS_DISKGETMODEL     37
+#define SYS_DISKSTATS        38
+#define SYS_DISKCOPY         39
+#define SYS_DISKZERO         40
+#define SYS_DISKADVISE       41
+#define SYS_DISKSETSHARE     42
+#define SYS_DISKPROCSTATS    43
+#define SYS_PHASE4SUBMIT     44
+#define SYS_LOCKSTATS        45
+#define SYS_SYSCALLSTATS     46
+#define SYS_TRACEDUMP        47
+#define SYS_PHASE4STATS      48
+
+/*
+ * pseudo-units for the RAID-0 volume striped across disk 0 and disk 1 and the
+ * RAID-1 volume mirrored on both; the synchronous disk calls accept them
+ * wherever they take a unit number
+ */
+#define DISK_UNIT_STRIPED    2
+#define DISK_UNIT_MIRRORED   3
+
+/*
+ * access-pattern hints for DiskAdvise; they decide whether a range's tracks are
+ * cached, whether reads in it read ahead, and which entries are evicted first
+ */
+#define DISK_ADVICE_NORMAL      0  // not cached; the default for every track
+#define DISK_ADVICE_SEQUENTIAL  1  // read ahead into cold entries that never evict hot ones
+#define DISK_ADVICE_RANDOM      2  // cached as hot, no read-ahead
+#define DISK_ADVICE_WILLNEED    3  // read into the cache now and kept hot
+#define DISK_ADVICE_DONTNEED    4  // dropped from the cache and not cached again
+
+/*
+ * disk shares for DiskSetShare: while several processes have requests queued on
+ * a unit, each is served sectors in proportion to its share
+ */
+#define DISK_DEFAULT_SHARE   100
+#define DISK_MAX_SHARE       1000
+
+/*
+ * a process's disk share, rate cap and transfer totals, returned by DiskProcStats
+ */
+typedef struct DiskProcCounters
+{
+    int pid;
+    int share;
+    int rateCap;             // sectors per second, 0 if uncapped
+    long long bytesRead;     // bytes of completed reads
+    long long bytesWritten;  // bytes of completed writes
+    int throttled;           // requests that waited for the rate cap
+} DiskProcCounters;
+
+/*
+ * operations for Phase4Submit, which runs a whole array of them with one trap;
+ * the fields of Phase4Op each operation uses are listed beside it
+ */
+#define PHASE4_OP_SLEEP      0  // count = seconds
+#define PHASE4_OP_TERMREAD   1  // buffer, count = buffer size, unit
+#define PHASE4_OP_TERMWRITE  2  // buffer, count = characters, unit
+#define PHASE4_OP_DISKREAD   3  // buffer, unit, track, first, count = sectors
+#define PHASE4_OP_DISKWRITE  4  // buffer, unit, track, first, count = sectors
+
+#define PHASE4_BATCH_MAX     32 // operations accepted by one Phase4Submit
+
+typedef struct Phase4Op
+{
+    int opcode;
+    void *buffer;
+    int unit;
+    int track;
+    int first;
+    int count;
+} Phase4Op;
+
+/*
+ * the outcome of one Phase4Op: result is what the matching single call would
+ * return, except that a disk transfer the device failed has a result of -1, and
+ * status is its device status or the number of characters moved
+ */
+typedef struct Phase4Completion
+{
+    int index;           // position of the operation in the submitted array
+    int result;
+    int status;
+} Phase4Completion;
+
+/*
+ * one fragment of a vectored disk transfer: sectors * USLOSS_DISK_SECTOR_SIZE
+ * bytes starting at buffer
+ */
+typedef struct DiskIovec
+{
+    void *buffer;
+    int sectors;
+} DiskIovec;
+
+/*
+ * a disk unit's fitted service-time model, in microseconds: a seek of d tracks
+ * costs seekBase + d * seekPerTrack and each sector costs transfer
+ */
+typedef struct DiskCostModel
+{
+    int seekBase;
+    int seekPerTrack;
+    int transfer;
+    int seekSamples;      // seeks the model has been fitted from
+    int transferSamples;  // sector transfers the model has been fitted from
+} DiskCostModel;
+
+/*
+ * histogram buckets in DiskUnitStats: bucket 0 counts times under
+ * DISK_HIST_BASE_US microseconds, each later bucket doubles the limit, and
+ * the last bucket counts everything longer
+ */
+#define DISK_HIST_BUCKETS    12
+#define DISK_HIST_BASE_US    1000
+
+/*
+ * counters the disk subsystem keeps for each unit, returned by DiskStats
+ */
+typedef struct DiskUnitStats
+{
+    int ops;              // requests completed
+    int sectors;          // sectors transferred by the device
+    int seekDistance;     // tracks the head has travelled
+    int queueDepth;       // requests queued or being serviced right now
+    int maxQueueDepth;
+    int mergedRequests;   // requests serviced in another request's device pass
+    int mergedPasses;     // device passes that serviced more than one request
+    int dedupHits;        // reads answered from an identical read already in flight
+    int mirrorReads;      // mirrored-volume reads sent to this unit
+    int mirrorSeekSaved;  // tracks of travel those reads avoided over the other unit
+    int cacheHits;        // reads answered entirely from the track cache
+    int readAheads;       // whole-track reads queued to fill the cache
+    int cacheEvictions;   // cached tracks displaced by another track
+    int warmTracks;       // tracks read in from the warm list at start
+    int warmHits;         // reads answered from those tracks
+    int waitHist[DISK_HIST_BUCKETS];     // time from request to start of service
+    int serviceHist[DISK_HIST_BUCKETS];  // time from start of service to completion
+} DiskUnitStats;
+
 extern void phase4_init(void);
 
 
 
+/*
+ * contention profile of one kernel lock, returned by LockStats; times are in
+ * microseconds
+ */
+#define LOCK_NAME_LEN        16
+
+typedef struct LockStatsEntry
+{
+    char name[LOCK_NAME_LEN];
+    int acquisitions;
+    int contended;           // acquisitions that had to wait for another holder
+    long long waitTotal;     // time spent waiting by those acquisitions
+    int waitMax;
+    long long holdTotal;     // time the lock was held, over all acquisitions
+    int holdMax;
+} LockStatsEntry;
+
+/*
+ * accounting of one system call number, returned by SyscallStats when the
+ * kernel is built with PHASE4_SYSCALL_STATS; times are in microseconds, and
+ * hist[0] counts calls under 2, hist[b] calls from 2^b up to 2^(b+1), and
+ * the last bucket everything longer
+ */
+#define SYSCALL_HIST_BUCKETS 24
+
+typedef struct SyscallStatsEntry
+{
+    int number;
+    int calls;
+    int errors;              // calls that returned -1 for invalid arguments
+    long long timeTotal;     // time spent in the kernel, over all calls
+    int timeMax;
+    int hist[SYSCALL_HIST_BUCKETS];
+} SyscallStatsEntry;
+
+/*
+ * a snapshot of the phase 4 subsystems, filled in by GetPhase4Stats; version
+ * and size identify the layout, and a later version only adds fields at the end
+ */
+#define PHASE4_STATS_VERSION 1
+#define PHASE4_STATS_TERMS   4  // USLOSS_TERM_UNITS
+#define PHASE4_STATS_DISKS   2  // USLOSS_DISK_UNITS
+
+typedef struct Phase4TermCounters
+{
+    int charsIn;          // characters received
+    int linesIn;          // lines handed to readers' buffers
+    int linesDropped;     // lines lost because all of the unit's buffers were full
+    int linesQueued;      // lines buffered but not yet read, right now
+    int charsOut;         // characters transmitted
+    int charsOverrun;     // characters lost because the terminal service queue was full
+} Phase4TermCounters;
+
+typedef struct Phase4DiskCounters
+{
+    int ops;              // requests completed
+    int sectors;          // sectors transferred by the device
+    int queueDepth;       // requests queued or being serviced right now
+    int maxQueueDepth;
+    int cacheHits;        // reads answered entirely from the track cache
+    int readAheads;       // whole-track reads queued to fill the cache
+    int cacheEvictions;   // cached tracks displaced by another track
+} Phase4DiskCounters;
+
+typedef struct Phase4Stats
+{
+    int version;          // PHASE4_STATS_VERSION
+    int size;             // sizeof(Phase4Stats) for that version
+    int clockTicks;       // clock interrupts since boot
+    int sleepers;         // processes in Sleep right now
+    Phase4TermCounters term[PHASE4_STATS_TERMS];
+    Phase4DiskCounters disk[PHASE4_STATS_DISKS];
+} Phase4Stats;
+
+/*
+ * a kernel mutex: the pid holding it and a FIFO of the pids blocked waiting
+ * for it, linked through a per-process table; pids are never 0
+ */
+typedef struct KernelMutex
+{
+    int holder;          // 0 if the mutex is free
+    int head;            // first waiting pid, 0 if none
+    int tail;            // last waiting pid, 0 if none
+    int acquiredAt;      // currentTime() when the holder got it
+    LockStatsEntry stats;
+} KernelMutex;
+
+/*
+ * a kernel event: a FIFO of the pids blocked waiting for it, linked through
+ * the same per-process table as the mutex waiters, and a level flag that
+ * remembers a signal no one was waiting for, so a wait that starts after
+ * the signal still returns
+ */
+typedef struct KernelEvent
+{
+    int signalled;       // 1 if the next wait returns at once
+    int head;            // first waiting pid, 0 if none
+    int tail;            // last waiting pid, 0 if none
+} KernelEvent;
+
 /*
  * kernel mode interfaces to the same mechanisms as the syscalls
  */
@@ -22,9 +273,51 @@ extern  int  kernDiskRead (void *diskBuffer, int unit, int track, int first,
 extern  int  kernDiskWrite(void *diskBuffer, int unit, int track, int first,
                            int sectors, int *status);
 extern  int  kernDiskSize (int unit, int *sector, int *track, int *disk);
+extern  int  kernDiskReadAsync (void *diskBuffer, int unit, int track,
+                                int first, int sectors, int *handle);
+extern  int  kernDiskWriteAsync(void *diskBuffer, int unit, int track,
+                                int first, int sectors, int *handle);
+extern  int  kernDiskWait      (int *handle, int *status);
+extern  int  kernDiskReadv (DiskIovec *iov, int iovCount, int unit, int track,
+                            int first, int *status);
+extern  int  kernDiskWritev(DiskIovec *iov, int iovCount, int unit, int track,
+                            int first, int *status);
+extern  int  kernDiskReadBlocks (void *diskBuffer, int unit, int lba, int count,
+                                 int *status);
+extern  int  kernDiskWriteBlocks(void *diskBuffer, int unit, int lba, int count,
+                                 int *status);
+extern  int  kernDiskGetModel(int unit, DiskCostModel *model);
+extern  int  kernDiskStats   (int unit, DiskUnitStats *stats);
+extern  void dumpDiskStats   (void);
+extern  int  kernDiskCopy(int srcUnit, int srcLBA, int dstUnit, int dstLBA,
+                          int count, int *status);
+extern  int  kernDiskZero(int unit, int track, int first, int sectors,
+                          int *status);
+extern  int  kernDiskAdvise(int unit, int track, int tracks, int hint);
+extern  int  kernDiskSetShare(int pid, int share, int rateCap);
+extern  int  kernDiskProcStats(int pid, DiskProcCounters *counters);
+extern  void kernClockWait(void);
+extern  int  kernDiskWaitAny(int *handles, int count, int *index, int *status);
+extern  int  kernPhase4Submit(Phase4Op *ops, int count,
+                              Phase4Completion *completions, int *completed);
+extern  void kernMutexInit  (KernelMutex *mutex, char *name);
+extern  void kernMutexLock  (KernelMutex *mutex);
+extern  void kernMutexUnlock(KernelMutex *mutex);
+extern  void kernEventInit  (KernelEvent *event);
+extern  void kernEventWait  (KernelEvent *event);
+extern  void kernEventSignal(KernelEvent *event);
+extern  void kernEventSignalAll(KernelEvent *event);
+extern  int  kernLockStats  (LockStatsEntry *entries, int max, int *count);
+extern  void dumpLockStats  (void);
+extern  int  kernSyscallStats(SyscallStatsEntry *entries, int max, int *count);
+extern  void dumpSyscallStats(void);
+extern  void dumpTrace(void);
+extern  int  kernGetPhase4Stats(Phase4Stats *stats);
 extern  int  kernTermRead (char *buffer, int bufferSize, int unitID,
                            int *numCharsRead);
 extern  int  kernTermWrite(char *buffer, int bufferSize, int unitID,
                            int *numCharsRead);
+extern  int  kernTermWriteLocked(char *buffer, int bufferSize, int unitID,
+                                 int *numCharsWritten);
 
 #endif /* _PHASE4_H */
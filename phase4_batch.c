@@ -0,0 +1,201 @@
+/*
+ * phase4_batch.c
+ *
+ * This file contains the batched submission system call for Phase 4 of the CS 452
+ * project, which carries any mix of sleep, terminal and disk operations into the
+ * kernel with a single trap.
+ *
+ * The caller fills an array of Phase4Op entries and gets back an array of
+ * Phase4Completion entries, one per operation, in the order the operations were
+ * seen to finish.  Disk transfers on disk 0 and disk 1 are all queued with the
+ * asynchronous disk calls before anything else runs, so both drivers work through
+ * them while the sleep and terminal operations are carried out in array order.
+ * A disk transfer that cannot be queued that way (a volume, or a process that has
+ * reached its limit of outstanding requests) is carried out synchronously in its
+ * place in the array instead.
+ *
+ * Operations in one batch are not ordered against each other beyond that, just
+ * as with separate asynchronous calls.
+ *
+ * Author: Ishika Patel & Hamad Marhoon
+ */
+
+#include <stdio.h>
+#include <phase1.h>
+#include <phase2.h>
+#include <phase3.h>
+#include <phase4.h>
+#include <string.h>
+#include <stdlib.h>
+
+void phase4SubmitHandler(USLOSS_Sysargs *sysargs);
+
+/*
+ * Installs the batched submission system call
+ *
+ * Returns: void
+ */
+void phase4_batch_init(void)
+{
+    systemCallVec[SYS_PHASE4SUBMIT] = phase4SubmitHandler;
+}
+
+/*
+ * Checks whether an operation is a disk transfer
+ *
+ * Parameters:
+ *   op - the operation
+ *
+ * Returns:
+ *   int - 1 for PHASE4_OP_DISKREAD or PHASE4_OP_DISKWRITE, 0 otherwise
+ */
+static int batchIsDisk(Phase4Op *op)
+{
+    return op->opcode == PHASE4_OP_DISKREAD || op->opcode == PHASE4_OP_DISKWRITE;
+}
+
+/*
+ * Returns the result to report for a disk transfer
+ * A transfer the device failed is reported as failed, so a caller only has to
+ * check result whether the transfer was queued or carried out in place
+ *
+ * Parameters:
+ *   result - what the disk call returned
+ *   status - the device status of the transfer
+ *
+ * Returns:
+ *   int - result, or -1 if the status is not USLOSS_DEV_READY
+ */
+static int batchDiskResult(int result, int status)
+{
+    return result == 0 && status != USLOSS_DEV_READY ? -1 : result;
+}
+
+/*
+ * Carries out one operation and waits for it to finish
+ *
+ * Parameters:
+ *   op - the operation
+ *   status - receives the device status for a disk transfer, or the number of
+ *            characters moved for a terminal operation
+ *
+ * Returns:
+ *   int - the result of the matching kernel call, -1 for an unknown opcode
+ */
+static int batchRun(Phase4Op *op, int *status)
+{
+    *status = 0;
+
+    switch (op->opcode)
+    {
+    case PHASE4_OP_SLEEP:
+        return kernSleep(op->count);
+    case PHASE4_OP_TERMREAD:
+        return kernTermRead(op->buffer, op->count, op->unit, status);
+    case PHASE4_OP_TERMWRITE:
+        return kernTermWriteLocked(op->buffer, op->count, op->unit, status);
+    case PHASE4_OP_DISKREAD:
+        return batchDiskResult(kernDiskRead(op->buffer, op->unit, op->track, op->first,
+                                            op->count, status), *status);
+    case PHASE4_OP_DISKWRITE:
+        return batchDiskResult(kernDiskWrite(op->buffer, op->unit, op->track, op->first,
+                                             op->count, status), *status);
+    default:
+        return -1;
+    }
+}
+
+/*
+ * Carries out a batch of operations and reports each one as it finishes
+ *
+ * Parameters:
+ *   ops - the operations
+ *   count - the number of operations, at most PHASE4_BATCH_MAX
+ *   completions - receives one entry per operation, in the order they finished
+ *   completed - receives the number of entries written to completions
+ *
+ * Returns:
+ *   int - returns 0 if the batch was run, -1 if invalid parameters are provided
+ */
+int kernPhase4Submit(Phase4Op *ops, int count, Phase4Completion *completions, int *completed)
+{
+    int handles[PHASE4_BATCH_MAX];
+    int done = 0;
+
+    if (ops == NULL || completions == NULL || count <= 0 || count > PHASE4_BATCH_MAX)
+    {
+        return -1;
+    }
+
+    // get both disk drivers busy before anything that might block
+    for (int i = 0; i < count; i++)
+    {
+        handles[i] = -1;
+        if (batchIsDisk(&ops[i]) && ops[i].unit >= 0 && ops[i].unit < USLOSS_DISK_UNITS)
+        {
+            int res;
+            if (ops[i].opcode == PHASE4_OP_DISKREAD)
+            {
+                res = kernDiskReadAsync(ops[i].buffer, ops[i].unit, ops[i].track,
+                                        ops[i].first, ops[i].count, &handles[i]);
+            }
+            else
+            {
+                res = kernDiskWriteAsync(ops[i].buffer, ops[i].unit, ops[i].track,
+                                         ops[i].first, ops[i].count, &handles[i]);
+            }
+            if (res != 0)
+            {
+                handles[i] = -1;
+            }
+        }
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        if (handles[i] >= 0)
+        {
+            continue;
+        }
+
+        completions[done].index = i;
+        completions[done].result = batchRun(&ops[i], &completions[done].status);
+        done++;
+    }
+
+    int index;
+    int status;
+    while (kernDiskWaitAny(handles, count, &index, &status) == 0)
+    {
+        handles[index] = -1;
+        completions[done].index = index;
+        completions[done].result = batchDiskResult(0, status);
+        completions[done].status = status;
+        done++;
+    }
+
+    *completed = done;
+    return 0;
+}
+
+/*
+ * System call handler for the batched submission operation
+ *
+ * Parameters:
+ *   sysargs - pointer to the USLOSS_Sysargs structure containing the system call arguments
+ *
+ * Returns:
+ *   void
+ */
+void phase4SubmitHandler(USLOSS_Sysargs *sysargs)
+{
+    Phase4Op *ops = (Phase4Op *)sysargs->arg1;
+    int count = (int)(long)sysargs->arg2;
+    Phase4Completion *completions = (Phase4Completion *)sysargs->arg3;
+    int completed = 0;
+
+    int res = kernPhase4Submit(ops, count, completions, &completed);
+
+    sysargs->arg1 = (void *)(long)completed;
+    sysargs->arg4 = (void *)(long)res;
+}
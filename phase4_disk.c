@@ -0,0 +1,3651 @@
+/*
+ * phase4_disk.c
+ *
+ * This file contains the disk device driver for Phase 4 of the CS 452 project,
+ * along with the system calls for reading, writing and sizing the disks.
+ *
+ * Every disk operation is described by a DiskRequest taken from a fixed table.
+ * Requests are queued per unit and serviced by one DiskDeviceDriver process per
+ * unit.  The driver sweeps the tracks upward like a C-SCAN elevator, and among the
+ * requests still ahead of the head it picks the one a per-unit cost model says
+ * will finish soonest.  The model (a fixed seek cost, a cost per track travelled
+ * and a cost per sector transferred) is fitted from the service times the driver
+ * measures with currentTime(), and can be read back with DiskGetModel.
+ * The synchronous DiskRead/DiskWrite calls submit a request and wait for it.
+ * The asynchronous calls return the request's index as a handle instead, so one
+ * process can keep several requests in flight on both units and collect them
+ * later with DiskWait (either a specific handle or whichever finishes first).
+ * The vectored calls describe the caller's memory as a list of fragments, and
+ * the driver moves each sector straight to or from the fragment it belongs in.
+ * When the driver picks a request, queued requests in the same direction whose
+ * sectors touch or overlap it are merged into a single device pass, and every
+ * request in the pass is completed when it ends.  A lone request covering whole
+ * tracks from sector 0 takes a fast path that seeks once per track and streams
+ * the sectors straight through the caller's buffer.  A read that exactly matches
+ * a read already on the device is attached to it rather than queued, and gets
+ * a copy of its data when the pass finishes.
+ *
+ * Each driver asks its unit for its track count when it starts and caches it,
+ * which lets the block calls address a unit as one run of logical sectors.
+ *
+ * DISK_UNIT_STRIPED is a RAID-0 volume over both units and DISK_UNIT_MIRRORED a
+ * RAID-1 volume.  The synchronous read, write, block and size calls accept either.
+ * A striped transfer is split into one request per unit so that both drivers
+ * service their halves at once.  A mirrored write goes to both units; a mirrored
+ * read goes to the unit with the shorter queue, or the nearer head if the queues
+ * are equal.
+ *
+ * DiskCopy moves a run of logical sectors between or within units without the
+ * data leaving the kernel, reading each track-sized chunk while the previous one
+ * is still being written.
+ *
+ * Tracks a unit has been advised about with DiskAdvise are kept in a small track
+ * cache, and a read whose sectors are all cached is answered without the device.
+ * RANDOM and WILLNEED ranges are cached as hot, WILLNEED ranges are also read in
+ * straight away, and reads in a SEQUENTIAL range read the next tracks ahead into
+ * cold entries that may only displace other cold entries, so a long scan cannot
+ * push the hot set out.  DONTNEED drops a range from the cache.  Reads outside
+ * any advised range are not cached.
+ *
+ * Built with DISK_WARM_LIST set, the driver keeps a warm list of each unit's hottest
+ * cached tracks in the unit's last track, which is then hidden from DiskSize and
+ * from every transfer.  The list is rewritten whenever it has changed and the
+ * driver goes idle, at most once per DISK_WARM_SAVE_US, and is read back when the
+ * driver starts so that those tracks are queued into the cache ahead of demand.
+ *
+ * Requests are also shared fairly between processes.  Each process has a virtual
+ * time per unit that advances by the sectors it is served divided by its share,
+ * and the driver only picks requests from processes whose virtual time is within
+ * DISK_FAIR_SLACK of the furthest-behind process with requests queued, so a bulk
+ * writer cannot hold a unit while another process's reads wait.  A process can
+ * also be capped to a number of sectors per second by a token bucket, and the bytes
+ * each process moves are counted.  A process that finds its bucket empty waits for
+ * the next clock tick and refills every bucket for the time that has passed, so the
+ * clock itself never touches the disk's state.
+ *
+ * DiskZero wipes a range by queueing track-sized writes that all point at one
+ * shared zero track, leaving the elevator to order and merge them.
+ *
+ * Each unit keeps counters of its operations, seeks, queue depth, merging and
+ * latency, which DiskStats returns and dumpDiskStats prints.
+ *
+ * Author: Ishika Patel & Hamad Marhoon
+ */
+
+#include <stdio.h>
+#include <phase1.h>
+#include <phase2.h>
+#include <phase3.h>
+#include <phase4.h>
+#include <phase4_trace.h>
+#include <string.h>
+#include <stdlib.h>
+
+#define DISK_MAX_INFLIGHT 8 // async requests a single process may have outstanding
+
+// on top of its async ones, a process's synchronous call may have up to DISK_MAX_INFLIGHT
+// requests (DiskZero's window; DiskCopy has 2), and each unit may have a read-ahead
+#define DISK_MAX_REQUESTS (MAXPROC * (2 * DISK_MAX_INFLIGHT + USLOSS_DISK_UNITS))
+
+#define DISK_MAX_IOV 16 // fragments accepted by a single vectored call
+
+#define DISK_MERGE_MAX_SECTORS (4 * USLOSS_DISK_TRACK_SIZE) // longest merged device pass
+
+#define DISK_IS_VOLUME(unit) ((unit) == DISK_UNIT_STRIPED || (unit) == DISK_UNIT_MIRRORED)
+
+// cost model used until a unit has been measured, in microseconds
+#define DISK_DEFAULT_SEEK_BASE   1000
+#define DISK_DEFAULT_SEEK_TRACK  100
+#define DISK_DEFAULT_TRANSFER    1000
+
+#define DISK_COPY_SLOTS 2 // DiskCopy calls that can run at once, each with two track buffers
+#define DISK_TRACK_BYTES (USLOSS_DISK_TRACK_SIZE * USLOSS_DISK_SECTOR_SIZE)
+
+// sectors per stripe of the striped volume; must divide USLOSS_DISK_TRACK_SIZE
+#ifndef DISK_STRIPE_SECTORS
+#define DISK_STRIPE_SECTORS 4
+#endif
+
+// set to 1 to keep a warm list of hot tracks in the last track of each unit
+#ifndef DISK_WARM_LIST
+#define DISK_WARM_LIST 0
+#endif
+#define DISK_WARM_RESERVED (DISK_WARM_LIST ? 1 : 0) // tracks at the end of each unit kept from callers
+#define DISK_WARM_MAX      8          // tracks recorded in a warm list
+#define DISK_WARM_MAGIC    0x5741524d // marks a sector holding a warm list
+#define DISK_WARM_SAVE_US  1000000    // least time between rewrites of a unit's warm list
+
+#define DISK_CACHE_TRACKS     16 // tracks the cache holds across both units
+#define DISK_READAHEAD_TRACKS 2  // tracks read ahead of a read in a SEQUENTIAL range
+#define DISK_ADVICE_RANGES    8  // advised ranges remembered per unit; the oldest is dropped first
+#define DISK_FULL_TRACK_MASK  ((1 << USLOSS_DISK_TRACK_SIZE) - 1)
+
+typedef struct DiskCacheTrack
+{
+    int unit;           // -1 if the entry is empty
+    int track;
+    int valid;          // one bit per sector holding the current contents of the disk
+    int filling;        // a read-ahead into data is queued or on the device
+    int stale;          // a write arrived while filling, so the read-ahead's data is discarded
+    int lastUse;        // stamp from diskCacheClock; 0 marks a cold entry
+    int warm;           // read in from the warm list when the driver started
+    char data[DISK_TRACK_BYTES];
+} DiskCacheTrack;
+
+typedef struct DiskWarmList
+{
+    int magic;          // DISK_WARM_MAGIC if the list is valid
+    int count;
+    int tracks[DISK_WARM_MAX]; // in ascending order, so reading them back is one sweep
+} DiskWarmList;
+
+typedef struct DiskAdviceRange
+{
+    int start;          // first track of the range
+    int end;            // one past its last track
+    int hint;           // one of the DISK_ADVICE_ values
+} DiskAdviceRange;
+
+#define DISK_VTIME_SCALE 1000 // virtual time per sector served at DISK_DEFAULT_SHARE
+#define DISK_FAIR_SLACK  (DISK_MERGE_MAX_SECTORS * DISK_VTIME_SCALE) // lead before a process waits its turn
+#define DISK_TOKEN_SCALE 1000000LL // token bucket units per sector, so refills are exact in microseconds
+
+typedef struct DiskProc
+{
+    int pid;                                // process the slot describes, -1 if unused
+    int share;                              // weight against other processes
+    int rateCap;                            // sectors per second, 0 if uncapped
+    long long tokens;                       // sectors * DISK_TOKEN_SCALE it may still transfer
+    long long vtime[USLOSS_DISK_UNITS];     // service received on each unit, scaled by share
+    int queued[USLOSS_DISK_UNITS];          // its requests waiting in each unit's queue
+    DiskProcCounters counters;              // totals reported by DiskProcStats
+} DiskProc;
+
+typedef struct DiskRequest
+{
+    int inUse;          // slot is allocated to a process
+    int done;           // driver has finished with the request
+    int async;          // counts against the owner's DISK_MAX_INFLIGHT
+    int op;             // USLOSS_DISK_READ, USLOSS_DISK_WRITE or USLOSS_DISK_TRACKS
+    int unit;
+    int track;
+    int first;
+    int sectors;        // total across all fragments; the track count for USLOSS_DISK_TRACKS
+    DiskIovec *iov;     // fragments of the caller's memory, in sector order
+    int iovCount;
+    DiskIovec single;   // storage for iov when there is only one fragment
+    int status;         // device status once done
+    int ownerPid;
+    int seq;            // arrival order, so overlapping writes land in the order issued
+    int submitTime;     // currentTime() when the request was made
+    int startTime;      // currentTime() when its device pass began
+    struct DiskRequest *next;
+    struct DiskRequest *mergeNext; // other requests sharing this one's device pass
+    struct DiskRequest *dupNext;   // identical reads waiting on a copy of this one's data
+    DiskCacheTrack *cache;         // entry a read-ahead fills; NULL for a process's request
+} DiskRequest;
+
+KernelMutex disk_lock; // lock for the request table and the unit queues
+
+DiskRequest diskRequestTable[DISK_MAX_REQUESTS];   // memory for every disk request
+DiskRequest *diskQueue[USLOSS_DISK_UNITS];         // pending requests for each unit, in arrival order
+int diskHeadTrack[USLOSS_DISK_UNITS];              // track the head is on, -1 if unknown
+int diskTracks[USLOSS_DISK_UNITS];                 // track count of each unit, -1 until known
+int diskNextSeq = 0;                               // arrival number for the next request
+
+DiskRequest *diskActive[USLOSS_DISK_UNITS]; // the pass each unit's driver is servicing, if any
+DiskUnitStats diskStats[USLOSS_DISK_UNITS]; // counters reported by DiskStats
+
+typedef struct DiskSamples
+{
+    long long seeks;           // number of timed seeks
+    long long seekDistance;    // sum of their distances
+    long long seekTime;        // sum of their times
+    long long seekDistanceSq;  // sum of distance * distance
+    long long seekProduct;     // sum of distance * time
+    long long transfers;       // number of timed sector transfers
+    long long transferTime;    // sum of their times
+} DiskSamples;
+
+DiskSamples diskSamples[USLOSS_DISK_UNITS]; // raw measurements behind each unit's model
+DiskCostModel diskModel[USLOSS_DISK_UNITS]; // fitted cost model for each unit
+
+char diskCopyBuffers[DISK_COPY_SLOTS][2][DISK_TRACK_BYTES]; // track buffers for DiskCopy
+int diskCopySlotsBusy = 0;                                   // bit i set while slot i is in use, under disk_lock
+KernelEvent diskCopySlotEvent;                               // signalled when a slot is given back
+
+char diskZeroTrack[DISK_TRACK_BYTES]; // never written; every DiskZero request writes from it
+
+DiskCacheTrack diskCache[DISK_CACHE_TRACKS];                       // cached tracks of both units
+int diskCacheClock = 0;                                            // last stamp given to a hot entry
+DiskAdviceRange diskAdvice[USLOSS_DISK_UNITS][DISK_ADVICE_RANGES]; // advised ranges, oldest first
+int diskAdviceCount[USLOSS_DISK_UNITS];                            // ranges in use for each unit
+
+DiskWarmList diskWarmSaved[USLOSS_DISK_UNITS]; // warm list last written to or read from each unit
+int diskWarmSaveTime[USLOSS_DISK_UNITS];       // currentTime() when it was written
+
+DiskProc diskProcs[MAXPROC];                    // fairness and accounting state, by pid % MAXPROC
+long long diskVirtualTime[USLOSS_DISK_UNITS];   // virtual time of the latest request dispatched
+int diskLastRefill;                             // currentTime() of the last token bucket refill
+
+KernelEvent diskWakeEvents[USLOSS_DISK_UNITS]; // wakes a unit's driver when a request is queued
+KernelEvent diskDoneEvents[MAXPROC];           // wakes a process when one of its requests is done
+
+int DiskDeviceDriver(char *arg);
+void driverEnsure(int device, int unit);
+void diskReadHandler(USLOSS_Sysargs *sysargs);
+void diskWriteHandler(USLOSS_Sysargs *sysargs);
+void diskSizeHandler(USLOSS_Sysargs *sysargs);
+void diskReadAsyncHandler(USLOSS_Sysargs *sysargs);
+void diskWriteAsyncHandler(USLOSS_Sysargs *sysargs);
+void diskWaitHandler(USLOSS_Sysargs *sysargs);
+void diskReadvHandler(USLOSS_Sysargs *sysargs);
+void diskWritevHandler(USLOSS_Sysargs *sysargs);
+void diskReadBlocksHandler(USLOSS_Sysargs *sysargs);
+void diskWriteBlocksHandler(USLOSS_Sysargs *sysargs);
+void diskGetModelHandler(USLOSS_Sysargs *sysargs);
+void diskStatsHandler(USLOSS_Sysargs *sysargs);
+void diskCopyHandler(USLOSS_Sysargs *sysargs);
+void diskZeroHandler(USLOSS_Sysargs *sysargs);
+void diskAdviseHandler(USLOSS_Sysargs *sysargs);
+void diskSetShareHandler(USLOSS_Sysargs *sysargs);
+void diskProcStatsHandler(USLOSS_Sysargs *sysargs);
+static int diskTrackCount(int unit);
+
+/*
+ * Initializes the disk data structures, the events used to hand requests
+ * to the drivers and completions back to the callers, and the disk system calls
+ *
+ * Returns: void
+ */
+void phase4_disk_init(void)
+{
+    memset(diskRequestTable, 0, sizeof(diskRequestTable));
+
+    systemCallVec[SYS_DISKREAD] = diskReadHandler;
+    systemCallVec[SYS_DISKWRITE] = diskWriteHandler;
+    systemCallVec[SYS_DISKSIZE] = diskSizeHandler;
+    systemCallVec[SYS_DISKREADASYNC] = diskReadAsyncHandler;
+    systemCallVec[SYS_DISKWRITEASYNC] = diskWriteAsyncHandler;
+    systemCallVec[SYS_DISKWAIT] = diskWaitHandler;
+    systemCallVec[SYS_DISKREADV] = diskReadvHandler;
+    systemCallVec[SYS_DISKWRITEV] = diskWritevHandler;
+    systemCallVec[SYS_DISKREADBLOCKS] = diskReadBlocksHandler;
+    systemCallVec[SYS_DISKWRITEBLOCKS] = diskWriteBlocksHandler;
+    systemCallVec[SYS_DISKGETMODEL] = diskGetModelHandler;
+    systemCallVec[SYS_DISKSTATS] = diskStatsHandler;
+    systemCallVec[SYS_DISKCOPY] = diskCopyHandler;
+    systemCallVec[SYS_DISKZERO] = diskZeroHandler;
+    systemCallVec[SYS_DISKADVISE] = diskAdviseHandler;
+    systemCallVec[SYS_DISKSETSHARE] = diskSetShareHandler;
+    systemCallVec[SYS_DISKPROCSTATS] = diskProcStatsHandler;
+
+    memset(diskSamples, 0, sizeof(diskSamples));
+    memset(diskStats, 0, sizeof(diskStats));
+
+    for (int i = 0; i < DISK_CACHE_TRACKS; i++)
+    {
+        diskCache[i].unit = -1;
+        diskCache[i].valid = 0;
+        diskCache[i].filling = 0;
+        diskCache[i].stale = 0;
+        diskCache[i].lastUse = 0;
+    }
+
+    kernMutexInit(&disk_lock, "disk");
+
+    diskCopySlotsBusy = 0;
+    kernEventInit(&diskCopySlotEvent);
+
+    for (int i = 0; i < USLOSS_DISK_UNITS; i++)
+    {
+        diskQueue[i] = NULL;
+        diskHeadTrack[i] = -1;
+        diskTracks[i] = -1;
+        diskActive[i] = NULL;
+        diskAdviceCount[i] = 0;
+        diskWarmSaved[i].magic = 0;
+        diskWarmSaved[i].count = 0;
+        diskWarmSaveTime[i] = 0;
+
+        diskModel[i].seekBase = DISK_DEFAULT_SEEK_BASE;
+        diskModel[i].seekPerTrack = DISK_DEFAULT_SEEK_TRACK;
+        diskModel[i].transfer = DISK_DEFAULT_TRANSFER;
+        diskModel[i].seekSamples = 0;
+        diskModel[i].transferSamples = 0;
+        kernEventInit(&diskWakeEvents[i]);
+    }
+
+    for (int i = 0; i < MAXPROC; i++)
+    {
+        kernEventInit(&diskDoneEvents[i]);
+        diskProcs[i].pid = -1;
+    }
+    memset(diskVirtualTime, 0, sizeof(diskVirtualTime));
+    diskLastRefill = currentTime();
+}
+
+/*
+ * Issues a single operation to a disk unit and waits for its interrupt
+ *
+ * Parameters:
+ *   unit - the disk unit
+ *   opr - the USLOSS disk operation
+ *   reg1, reg2 - the operation's arguments, as described by USLOSS_DeviceRequest
+ *
+ * Returns:
+ *   int - the device status after the operation completes
+ */
+static int diskDeviceOp(int unit, int opr, void *reg1, void *reg2)
+{
+    USLOSS_DeviceRequest request;
+    int status;
+
+    request.opr = opr;
+    request.reg1 = reg1;
+    request.reg2 = reg2;
+
+    TRACE(TRACE_CLASS_DISK, TRACE_DISK_START, unit, opr, (int)(long)reg1);
+    if (USLOSS_DeviceOutput(USLOSS_DISK_DEV, unit, &request) != USLOSS_DEV_OK)
+    {
+        return USLOSS_DEV_ERROR;
+    }
+
+    waitDevice(USLOSS_DISK_DEV, unit, &status);
+    TRACE(TRACE_CLASS_INTERRUPT, TRACE_INTERRUPT, USLOSS_DISK_DEV, unit, status);
+    TRACE(TRACE_CLASS_DISK, TRACE_DISK_END, unit, opr, status);
+    return status;
+}
+
+/*
+ * Predicts how long a request will take from a given head position using the unit's model
+ * Every track boundary the transfer crosses costs a one-track seek
+ *
+ * Parameters:
+ *   unit - the disk unit
+ *   req - the request
+ *   head - the track the head starts on
+ *
+ * Returns:
+ *   int - the predicted service time in microseconds
+ */
+static int diskPredict(int unit, DiskRequest *req, int head)
+{
+    DiskCostModel *model = &diskModel[unit];
+    int distance = abs(req->track - head);
+    int crossings = (req->first + req->sectors - 1) / USLOSS_DISK_TRACK_SIZE;
+    int cost = req->sectors * model->transfer;
+
+    if (distance > 0)
+    {
+        cost += model->seekBase + distance * model->seekPerTrack;
+    }
+    cost += crossings * (model->seekBase + model->seekPerTrack);
+    return cost;
+}
+
+/*
+ * Returns the fairness and accounting record of a process, starting a fresh one
+ * if its slot last described a different process
+ * Must be called with disk_lock held
+ *
+ * Parameters:
+ *   pid - the process
+ *
+ * Returns:
+ *   DiskProc * - the record
+ */
+static DiskProc *diskProc(int pid)
+{
+    DiskProc *proc = &diskProcs[pid % MAXPROC];
+    if (proc->pid != pid)
+    {
+        memset(proc, 0, sizeof(DiskProc));
+        proc->pid = pid;
+        proc->share = DISK_DEFAULT_SHARE;
+        proc->counters.pid = pid;
+        proc->counters.share = DISK_DEFAULT_SHARE;
+    }
+    return proc;
+}
+
+/*
+ * Finds the least virtual time among the processes with requests queued on a unit
+ * Must be called with disk_lock held
+ *
+ * Parameters:
+ *   unit - the disk unit
+ *
+ * Returns:
+ *   long long - that virtual time, or the unit's current virtual time if no
+ *               process has a request queued
+ */
+static long long diskFairFloor(int unit)
+{
+    long long floor = -1;
+
+    for (DiskRequest *cur = diskQueue[unit]; cur != NULL; cur = cur->next)
+    {
+        if (cur->ownerPid >= 0)
+        {
+            long long vtime = diskProcs[cur->ownerPid % MAXPROC].vtime[unit];
+            if (floor == -1 || vtime < floor)
+            {
+                floor = vtime;
+            }
+        }
+    }
+    return floor == -1 ? diskVirtualTime[unit] : floor;
+}
+
+/*
+ * Checks whether a queued request's owner is close enough to the furthest-behind
+ * process for the request to be picked
+ * Kernel read-aheads have no owner and are always eligible
+ *
+ * Parameters:
+ *   req - the queued request
+ *   floor - the unit's value from diskFairFloor
+ *
+ * Returns:
+ *   int - 1 if the request may be picked, 0 if its owner has to wait its turn
+ */
+static int diskEligible(DiskRequest *req, long long floor)
+{
+    if (req->ownerPid < 0)
+    {
+        return 1;
+    }
+    return diskProcs[req->ownerPid % MAXPROC].vtime[req->unit] - floor <= DISK_FAIR_SLACK;
+}
+
+/*
+ * Charges the owner of a request being dispatched for the sectors it will be served
+ * Must be called with disk_lock held
+ *
+ * Parameters:
+ *   req - the request
+ *
+ * Returns: void
+ */
+static void diskCharge(DiskRequest *req)
+{
+    if (req->ownerPid < 0)
+    {
+        return;
+    }
+
+    DiskProc *proc = &diskProcs[req->ownerPid % MAXPROC];
+    if (proc->vtime[req->unit] > diskVirtualTime[req->unit])
+    {
+        diskVirtualTime[req->unit] = proc->vtime[req->unit];
+    }
+    proc->vtime[req->unit] += (long long)req->sectors * DISK_VTIME_SCALE * DISK_DEFAULT_SHARE / proc->share;
+    proc->queued[req->unit]--;
+}
+
+/*
+ * Checks whether an older request still queued on the unit touches the same sectors
+ * as a request, in a way that makes their order matter
+ * Two reads may pass each other; anything involving a write may not, or a read
+ * could return data from before a write issued ahead of it, or an older write could
+ * land over a newer one
+ * Must be called with disk_lock held
+ *
+ * Parameters:
+ *   unit - the disk unit
+ *   req - the queued request
+ *
+ * Returns:
+ *   int - 1 if req has to wait for an older request, 0 if it may be serviced now
+ */
+static int diskBlocked(int unit, DiskRequest *req)
+{
+    if (req->op == USLOSS_DISK_TRACKS)
+    {
+        return 0;
+    }
+
+    int start = req->track * USLOSS_DISK_TRACK_SIZE + req->first;
+    int end = start + req->sectors;
+
+    for (DiskRequest *cur = diskQueue[unit]; cur != NULL; cur = cur->next)
+    {
+        if (cur->seq >= req->seq || cur->op == USLOSS_DISK_TRACKS ||
+            (cur->op == USLOSS_DISK_READ && req->op == USLOSS_DISK_READ))
+        {
+            continue;
+        }
+
+        int curStart = cur->track * USLOSS_DISK_TRACK_SIZE + cur->first;
+        if (curStart < end && start < curStart + cur->sectors)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Takes the next request for a unit off its queue
+ * The head sweeps upward as in C-SCAN; of the requests at or beyond it, the one
+ * with the lowest predicted service time wins, ties going to the nearer and then
+ * the oldest request
+ * If nothing is left in that direction, the sweep restarts at the lowest track
+ * A request that overlaps an older queued one (see diskBlocked) is passed over until
+ * that one has gone; if that leaves nothing to pick, the oldest request is taken,
+ * since nothing is older than it and it may be what the others are waiting for
+ * Must be called with disk_lock held
+ *
+ * Parameters:
+ *   unit - the disk unit
+ *
+ * Returns:
+ *   DiskRequest * - the request to service, or NULL if the queue is empty
+ */
+static DiskRequest *diskPickNext(int unit)
+{
+    DiskRequest *best = NULL;
+    DiskRequest *bestPrev = NULL;
+    DiskRequest *prev = NULL;
+    int bestCost = 0;
+    int head = diskHeadTrack[unit];
+    int ahead = 0;
+    int lowest = -1;
+    long long floor = diskFairFloor(unit);
+
+    for (DiskRequest *cur = diskQueue[unit]; cur != NULL; prev = cur, cur = cur->next)
+    {
+        // size queries don't move the head, so they never wait for a sweep
+        if (cur->op == USLOSS_DISK_TRACKS)
+        {
+            best = cur;
+            bestPrev = prev;
+            break;
+        }
+        if (!diskEligible(cur, floor) || diskBlocked(unit, cur))
+        {
+            continue;
+        }
+
+        if (cur->track >= head)
+        {
+            ahead = 1;
+        }
+        if (lowest == -1 || cur->track < lowest)
+        {
+            lowest = cur->track;
+        }
+    }
+
+    if (best == NULL)
+    {
+        int from = ahead ? head : lowest;
+
+        prev = NULL;
+        for (DiskRequest *cur = diskQueue[unit]; cur != NULL; prev = cur, cur = cur->next)
+        {
+            if (cur->track < from || !diskEligible(cur, floor) || diskBlocked(unit, cur))
+            {
+                continue;
+            }
+
+            // the nearer request wins a tie, so a flat seek cost still sweeps in track order
+            int cost = diskPredict(unit, cur, from);
+            if (best == NULL || cost < bestCost || (cost == bestCost && cur->track < best->track))
+            {
+                best = cur;
+                bestPrev = prev;
+                bestCost = cost;
+            }
+        }
+    }
+
+    if (best == NULL)
+    {
+        prev = NULL;
+        for (DiskRequest *cur = diskQueue[unit]; cur != NULL; prev = cur, cur = cur->next)
+        {
+            if (best == NULL || cur->seq < best->seq)
+            {
+                best = cur;
+                bestPrev = prev;
+            }
+        }
+    }
+
+    if (best == NULL)
+    {
+        return NULL;
+    }
+
+    if (bestPrev == NULL)
+    {
+        diskQueue[unit] = best->next;
+    }
+    else
+    {
+        bestPrev->next = best->next;
+    }
+    best->next = NULL;
+    return best;
+}
+
+/*
+ * Adds a timed seek to a unit's samples and statistics and refits the seek part of
+ * its model
+ * The fit is a least-squares line through (distance, time)
+ * Takes disk_lock, so that kernDiskGetModel and the scheduler never see a half-updated model
+ *
+ * Parameters:
+ *   unit - the disk unit
+ *   distance - the number of tracks the head travelled
+ *   elapsed - the measured time in microseconds
+ *
+ * Returns: void
+ */
+static void diskRecordSeek(int unit, int distance, int elapsed)
+{
+    DiskSamples *samples = &diskSamples[unit];
+    DiskCostModel *model = &diskModel[unit];
+
+    kernMutexLock(&disk_lock);
+
+    diskStats[unit].seekDistance += distance;
+    samples->seeks++;
+    samples->seekDistance += distance;
+    samples->seekTime += elapsed;
+    samples->seekDistanceSq += (long long)distance * distance;
+    samples->seekProduct += (long long)distance * elapsed;
+
+    long long n = samples->seeks;
+    long long spread = n * samples->seekDistanceSq - samples->seekDistance * samples->seekDistance;
+    long long base = samples->seekTime / n;
+    long long perTrack = model->seekPerTrack;
+
+    // until two different distances have been seen only the average can be fitted
+    if (spread != 0)
+    {
+        perTrack = (n * samples->seekProduct - samples->seekDistance * samples->seekTime) / spread;
+        if (perTrack < 0)
+        {
+            perTrack = 0;
+        }
+        base = (samples->seekTime - perTrack * samples->seekDistance) / n;
+        if (base < 0)
+        {
+            base = 0;
+        }
+    }
+
+    model->seekBase = (int)base;
+    model->seekPerTrack = (int)perTrack;
+    model->seekSamples = (int)n;
+
+    kernMutexUnlock(&disk_lock);
+}
+
+/*
+ * Adds a timed sector transfer to a unit's samples and statistics and refits the
+ * transfer cost
+ * Takes disk_lock, like diskRecordSeek
+ *
+ * Parameters:
+ *   unit - the disk unit
+ *   elapsed - the measured time in microseconds
+ *
+ * Returns: void
+ */
+static void diskRecordTransfer(int unit, int elapsed)
+{
+    DiskSamples *samples = &diskSamples[unit];
+
+    kernMutexLock(&disk_lock);
+
+    diskStats[unit].sectors++;
+    samples->transfers++;
+    samples->transferTime += elapsed;
+
+    diskModel[unit].transfer = (int)(samples->transferTime / samples->transfers);
+    diskModel[unit].transferSamples = (int)samples->transfers;
+
+    kernMutexUnlock(&disk_lock);
+}
+
+/*
+ * Counts a time in the histogram bucket it falls in
+ * Bucket 0 holds times under DISK_HIST_BASE_US and each later bucket doubles the
+ * limit, with the last bucket taking everything longer
+ *
+ * Parameters:
+ *   hist - the histogram, DISK_HIST_BUCKETS long
+ *   elapsed - the time in microseconds
+ *
+ * Returns: void
+ */
+static void diskHistAdd(int *hist, int elapsed)
+{
+    int bucket = 0;
+    int limit = DISK_HIST_BASE_US;
+
+    while (bucket < DISK_HIST_BUCKETS - 1 && elapsed >= limit)
+    {
+        bucket++;
+        limit *= 2;
+    }
+    hist[bucket]++;
+}
+
+/*
+ * Records that a request has started its device pass, or has been attached to one
+ * Must be called with disk_lock held
+ *
+ * Parameters:
+ *   req - the request
+ *   now - the current time
+ *
+ * Returns: void
+ */
+static void diskQueued(DiskRequest *req, int now)
+{
+    req->startTime = now;
+    diskHistAdd(diskStats[req->unit].waitHist, now - req->submitTime);
+}
+
+/*
+ * Returns the absolute sector number a request starts at
+ *
+ * Parameters:
+ *   req - the request
+ *
+ * Returns:
+ *   int - track * USLOSS_DISK_TRACK_SIZE + first
+ */
+static int diskStartSector(DiskRequest *req)
+{
+    return req->track * USLOSS_DISK_TRACK_SIZE + req->first;
+}
+
+/*
+ * Moves queued requests whose sectors touch or overlap a picked request into its device pass
+ * Only requests in the same direction are merged, the pass never grows beyond
+ * DISK_MERGE_MAX_SECTORS, and a request that has to wait for an older one (see
+ * diskBlocked) is left queued
+ * Must be called with disk_lock held
+ *
+ * Parameters:
+ *   unit - the disk unit
+ *   group - the picked request, which leads the pass
+ *
+ * Returns: void
+ */
+static void diskMerge(int unit, DiskRequest *group)
+{
+    if (group->op == USLOSS_DISK_TRACKS)
+    {
+        return;
+    }
+
+    int start = diskStartSector(group);
+    int end = start + group->sectors;
+    int merged = 1;
+
+    // a merge can widen the pass enough to reach requests already passed over, so rescan
+    while (merged)
+    {
+        merged = 0;
+        DiskRequest *prev = NULL;
+        for (DiskRequest *cur = diskQueue[unit]; cur != NULL; prev = cur, cur = cur->next)
+        {
+            int curStart = diskStartSector(cur);
+            int curEnd = curStart + cur->sectors;
+            if (cur->op != group->op || curStart > end || curEnd < start)
+            {
+                continue;
+            }
+
+            int newStart = curStart < start ? curStart : start;
+            int newEnd = curEnd > end ? curEnd : end;
+            if (newEnd - newStart > DISK_MERGE_MAX_SECTORS || diskBlocked(unit, cur))
+            {
+                continue;
+            }
+
+            if (prev == NULL)
+            {
+                diskQueue[unit] = cur->next;
+            }
+            else
+            {
+                prev->next = cur->next;
+            }
+            cur->next = NULL;
+
+            if (group->mergeNext == NULL)
+            {
+                diskStats[unit].mergedPasses++;
+            }
+            diskStats[unit].mergedRequests++;
+            cur->mergeNext = group->mergeNext;
+            group->mergeNext = cur;
+
+            start = newStart;
+            end = newEnd;
+            merged = 1;
+            break;
+        }
+    }
+}
+
+/*
+ * Finds where a sector of a request lives in the caller's fragments
+ *
+ * Parameters:
+ *   req - the request
+ *   index - the sector's position within the request
+ *
+ * Returns:
+ *   char * - the start of that sector's USLOSS_DISK_SECTOR_SIZE bytes
+ */
+static char *diskSectorBuffer(DiskRequest *req, int index)
+{
+    int frag = 0;
+    while (index >= req->iov[frag].sectors)
+    {
+        index -= req->iov[frag].sectors;
+        frag++;
+    }
+    return (char *)req->iov[frag].buffer + index * USLOSS_DISK_SECTOR_SIZE;
+}
+
+/*
+ * Finds the most recent advice covering a track
+ * Must be called with disk_lock held
+ *
+ * Parameters:
+ *   unit - the disk unit
+ *   track - the track
+ *
+ * Returns:
+ *   int - the DISK_ADVICE_ hint, DISK_ADVICE_NORMAL if the track was never advised
+ */
+static int diskAdviceFor(int unit, int track)
+{
+    for (int i = diskAdviceCount[unit] - 1; i >= 0; i--)
+    {
+        if (track >= diskAdvice[unit][i].start && track < diskAdvice[unit][i].end)
+        {
+            return diskAdvice[unit][i].hint;
+        }
+    }
+    return DISK_ADVICE_NORMAL;
+}
+
+/*
+ * Finds the cache entry for a track
+ * Must be called with disk_lock held
+ *
+ * Parameters:
+ *   unit - the disk unit
+ *   track - the track
+ *
+ * Returns:
+ *   DiskCacheTrack * - the entry, or NULL if the track is not cached
+ */
+static DiskCacheTrack *diskCacheFind(int unit, int track)
+{
+    for (int i = 0; i < DISK_CACHE_TRACKS; i++)
+    {
+        if (diskCache[i].unit == unit && diskCache[i].track == track)
+        {
+            return &diskCache[i];
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Checks whether a queued write touches any sector of a track
+ * Must be called with disk_lock held
+ *
+ * Parameters:
+ *   unit - the disk unit
+ *   track - the track
+ *
+ * Returns:
+ *   int - 1 if such a write is queued, 0 otherwise
+ */
+static int diskWritePending(int unit, int track)
+{
+    int start = track * USLOSS_DISK_TRACK_SIZE;
+    int end = start + USLOSS_DISK_TRACK_SIZE;
+
+    for (DiskRequest *cur = diskQueue[unit]; cur != NULL; cur = cur->next)
+    {
+        int curStart = diskStartSector(cur);
+        if (cur->op == USLOSS_DISK_WRITE && curStart < end && curStart + cur->sectors > start)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Marks a cache entry as used, hot or cold according to the advice for its track
+ * Must be called with disk_lock held
+ *
+ * Parameters:
+ *   entry - the cache entry
+ *   hint - the advice covering its track
+ *
+ * Returns: void
+ */
+static void diskCacheTouch(DiskCacheTrack *entry, int hint)
+{
+    if (hint != DISK_ADVICE_SEQUENTIAL)
+    {
+        entry->lastUse = ++diskCacheClock;
+    }
+}
+
+/*
+ * Returns the cache entry for a track, taking over the least recently used entry
+ * if the track has none
+ * Under SEQUENTIAL advice only empty or cold entries may be taken over, so a scan
+ * recycles its own entries instead of evicting hot ones
+ * Must be called with disk_lock held
+ *
+ * Parameters:
+ *   unit - the disk unit
+ *   track - the track
+ *   hint - the advice covering the track
+ *
+ * Returns:
+ *   DiskCacheTrack * - the entry, or NULL if no entry may be taken over
+ */
+static DiskCacheTrack *diskCacheAlloc(int unit, int track, int hint)
+{
+    DiskCacheTrack *entry = diskCacheFind(unit, track);
+    if (entry != NULL)
+    {
+        return entry;
+    }
+
+    for (int i = 0; i < DISK_CACHE_TRACKS; i++)
+    {
+        DiskCacheTrack *cur = &diskCache[i];
+        if (cur->filling || (hint == DISK_ADVICE_SEQUENTIAL && cur->unit != -1 && cur->lastUse != 0))
+        {
+            continue;
+        }
+        if (entry == NULL || cur->unit == -1 || (entry->unit != -1 && cur->lastUse < entry->lastUse))
+        {
+            entry = cur;
+        }
+    }
+    if (entry == NULL)
+    {
+        return NULL;
+    }
+
+    if (entry->unit != -1)
+    {
+        diskStats[entry->unit].cacheEvictions++;
+    }
+    entry->unit = unit;
+    entry->track = track;
+    entry->valid = 0;
+    entry->stale = 0;
+    entry->lastUse = 0;
+    entry->warm = 0;
+    return entry;
+}
+
+/*
+ * Drops a cache entry
+ * An entry still being filled is only marked stale, and is emptied when its
+ * read-ahead completes
+ * Must be called with disk_lock held
+ *
+ * Parameters:
+ *   entry - the cache entry
+ *
+ * Returns: void
+ */
+static void diskCacheDrop(DiskCacheTrack *entry)
+{
+    entry->valid = 0;
+    if (entry->filling)
+    {
+        entry->stale = 1;
+    }
+    else
+    {
+        entry->unit = -1;
+    }
+}
+
+/*
+ * Answers a read from the cache if every sector it covers is cached
+ * Must be called with disk_lock held
+ *
+ * Parameters:
+ *   req - the read
+ *
+ * Returns:
+ *   int - 1 if the read's buffers were filled from the cache, 0 otherwise
+ */
+static int diskCacheRead(DiskRequest *req)
+{
+    int start = diskStartSector(req);
+
+    for (int s = start; s < start + req->sectors; s++)
+    {
+        DiskCacheTrack *entry = diskCacheFind(req->unit, s / USLOSS_DISK_TRACK_SIZE);
+        if (entry == NULL || !(entry->valid & (1 << (s % USLOSS_DISK_TRACK_SIZE))))
+        {
+            return 0;
+        }
+    }
+
+    DiskCacheTrack *entry = NULL;
+    int warm = 0;
+    for (int s = start; s < start + req->sectors; s++)
+    {
+        if (entry == NULL || entry->track != s / USLOSS_DISK_TRACK_SIZE)
+        {
+            entry = diskCacheFind(req->unit, s / USLOSS_DISK_TRACK_SIZE);
+            diskCacheTouch(entry, diskAdviceFor(req->unit, entry->track));
+            warm |= entry->warm;
+        }
+        memcpy(diskSectorBuffer(req, s - start),
+               entry->data + (s % USLOSS_DISK_TRACK_SIZE) * USLOSS_DISK_SECTOR_SIZE,
+               USLOSS_DISK_SECTOR_SIZE);
+    }
+    if (warm)
+    {
+        diskStats[req->unit].warmHits++;
+    }
+    return 1;
+}
+
+/*
+ * Copies the sectors a finished read brought in into the cache, for the tracks
+ * whose advice admits them
+ * Tracks with a write queued against them are skipped, since the data just read
+ * is about to be out of date
+ * Must be called with disk_lock held
+ *
+ * Parameters:
+ *   req - the finished read
+ *
+ * Returns: void
+ */
+static void diskCacheAdmit(DiskRequest *req)
+{
+    int start = diskStartSector(req);
+
+    for (int s = start; s < start + req->sectors; s++)
+    {
+        int track = s / USLOSS_DISK_TRACK_SIZE;
+        int hint = diskAdviceFor(req->unit, track);
+        DiskCacheTrack *entry = diskCacheFind(req->unit, track);
+
+        if (entry == NULL && hint != DISK_ADVICE_RANDOM && hint != DISK_ADVICE_WILLNEED &&
+            hint != DISK_ADVICE_SEQUENTIAL)
+        {
+            continue;
+        }
+        if ((entry != NULL && entry->filling) || diskWritePending(req->unit, track))
+        {
+            continue;
+        }
+        if (entry == NULL)
+        {
+            entry = diskCacheAlloc(req->unit, track, hint);
+            if (entry == NULL)
+            {
+                continue;
+            }
+            diskCacheTouch(entry, hint);
+        }
+
+        memcpy(entry->data + (s % USLOSS_DISK_TRACK_SIZE) * USLOSS_DISK_SECTOR_SIZE,
+               diskSectorBuffer(req, s - start), USLOSS_DISK_SECTOR_SIZE);
+        entry->valid |= 1 << (s % USLOSS_DISK_TRACK_SIZE);
+    }
+}
+
+/*
+ * Drops the sectors a new write covers from the cache
+ * Must be called with disk_lock held
+ *
+ * Parameters:
+ *   req - the new write
+ *
+ * Returns: void
+ */
+static void diskCacheInvalidate(DiskRequest *req)
+{
+    int start = diskStartSector(req);
+
+    for (int s = start; s < start + req->sectors; s++)
+    {
+        DiskCacheTrack *entry = diskCacheFind(req->unit, s / USLOSS_DISK_TRACK_SIZE);
+        if (entry != NULL)
+        {
+            entry->valid &= ~(1 << (s % USLOSS_DISK_TRACK_SIZE));
+            if (entry->filling)
+            {
+                entry->stale = 1;
+            }
+        }
+    }
+}
+
+/*
+ * Appends a request to its unit's queue
+ * Must be called with disk_lock held
+ *
+ * Parameters:
+ *   req - the request
+ *
+ * Returns: void
+ */
+static void diskEnqueue(DiskRequest *req)
+{
+    // append so that equal-track requests keep their arrival order
+    if (diskQueue[req->unit] == NULL)
+    {
+        diskQueue[req->unit] = req;
+    }
+    else
+    {
+        DiskRequest *tail = diskQueue[req->unit];
+        while (tail->next != NULL)
+        {
+            tail = tail->next;
+        }
+        tail->next = req;
+    }
+}
+
+/*
+ * Queues a kernel read of a whole track into the cache
+ * Nothing is queued if the track is already cached or on its way, is outside the
+ * unit, has a write queued against it, or no cache entry or request is free
+ * The caller must wake the unit's driver if this returns 1
+ * Must be called with disk_lock held
+ *
+ * Parameters:
+ *   unit - the disk unit
+ *   track - the track to read
+ *   hint - the advice covering the track, which decides how the entry is kept
+ *
+ * Returns:
+ *   int - 1 if a read was queued, 0 otherwise
+ */
+static int diskPrefetch(int unit, int track, int hint)
+{
+    if (diskTracks[unit] < 0 || track < 0 || track >= diskTracks[unit] || diskWritePending(unit, track))
+    {
+        return 0;
+    }
+
+    DiskCacheTrack *entry = diskCacheFind(unit, track);
+    if (entry != NULL && (entry->filling || entry->valid == DISK_FULL_TRACK_MASK))
+    {
+        return 0;
+    }
+
+    int slot = -1;
+    for (int i = 0; i < DISK_MAX_REQUESTS && slot == -1; i++)
+    {
+        if (!diskRequestTable[i].inUse)
+        {
+            slot = i;
+        }
+    }
+    if (slot == -1)
+    {
+        return 0;
+    }
+
+    entry = diskCacheAlloc(unit, track, hint);
+    if (entry == NULL)
+    {
+        return 0;
+    }
+    entry->valid = 0;
+    entry->filling = 1;
+    diskCacheTouch(entry, hint);
+
+    DiskRequest *req = &diskRequestTable[slot];
+    req->inUse = 1;
+    req->done = 0;
+    req->async = 0;
+    req->op = USLOSS_DISK_READ;
+    req->unit = unit;
+    req->track = track;
+    req->first = 0;
+    req->sectors = USLOSS_DISK_TRACK_SIZE;
+    req->single.buffer = entry->data;
+    req->single.sectors = USLOSS_DISK_TRACK_SIZE;
+    req->iov = &req->single;
+    req->iovCount = 1;
+    req->status = 0;
+    req->ownerPid = -1;
+    req->seq = diskNextSeq++;
+    req->next = NULL;
+    req->mergeNext = NULL;
+    req->dupNext = NULL;
+    req->cache = entry;
+    req->submitTime = currentTime();
+
+    DiskUnitStats *stats = &diskStats[unit];
+    stats->readAheads++;
+    stats->queueDepth++;
+    if (stats->queueDepth > stats->maxQueueDepth)
+    {
+        stats->maxQueueDepth = stats->queueDepth;
+    }
+
+    diskEnqueue(req);
+    return 1;
+}
+
+/*
+ * Performs an unmerged request that covers whole tracks from sector 0 into or out of
+ * a single buffer
+ * Each track costs one seek and then a straight run over its sectors, with no
+ * per-sector bookkeeping about which request or fragment a sector belongs to
+ *
+ * Parameters:
+ *   unit - the disk unit
+ *   req - the request
+ *
+ * Returns: void
+ */
+static void diskServiceTracks(int unit, DiskRequest *req)
+{
+    char *buffer = req->iov[0].buffer;
+    int tracks = req->sectors / USLOSS_DISK_TRACK_SIZE;
+
+    req->status = USLOSS_DEV_READY;
+
+    for (int t = 0; t < tracks; t++)
+    {
+        int track = req->track + t;
+
+        if (diskHeadTrack[unit] != track)
+        {
+            int from = diskHeadTrack[unit];
+            int started = currentTime();
+            int status = diskDeviceOp(unit, USLOSS_DISK_SEEK, (void *)(long)track, NULL);
+            if (status != USLOSS_DEV_READY)
+            {
+                diskHeadTrack[unit] = -1;
+                req->status = status;
+                return;
+            }
+            if (from >= 0)
+            {
+                diskRecordSeek(unit, abs(track - from), currentTime() - started);
+            }
+            diskHeadTrack[unit] = track;
+        }
+
+        for (int sector = 0; sector < USLOSS_DISK_TRACK_SIZE; sector++)
+        {
+            int started = currentTime();
+            int status = diskDeviceOp(unit, req->op, (void *)(long)sector, buffer);
+            if (status != USLOSS_DEV_READY)
+            {
+                req->status = status;
+                return;
+            }
+            diskRecordTransfer(unit, currentTime() - started);
+            buffer += USLOSS_DISK_SECTOR_SIZE;
+        }
+    }
+}
+
+/*
+ * Performs a device pass for a request and any requests merged into it,
+ * seeking whenever the transfer reaches a new track
+ * Transfers that run past the end of a track continue at sector 0 of the next one
+ * Each sector goes directly to or from its place in a request's fragments; a sector
+ * that several reads want is read once and copied, and a sector that several writes
+ * cover is written from the latest of them
+ * The result is left in each request's status field
+ *
+ * Parameters:
+ *   unit - the disk unit
+ *   group - the request leading the pass
+ *
+ * Returns: void
+ */
+static void diskService(int unit, DiskRequest *group)
+{
+    if (group->op == USLOSS_DISK_TRACKS)
+    {
+        int tracks = 0;
+        group->status = diskDeviceOp(unit, USLOSS_DISK_TRACKS, &tracks, NULL);
+        group->sectors = tracks - DISK_WARM_RESERVED;
+        if (group->status == USLOSS_DEV_READY)
+        {
+            diskTracks[unit] = tracks - DISK_WARM_RESERVED;
+        }
+        return;
+    }
+
+    if (group->mergeNext == NULL && group->iovCount == 1 && group->first == 0 &&
+        group->sectors % USLOSS_DISK_TRACK_SIZE == 0)
+    {
+        diskServiceTracks(unit, group);
+        return;
+    }
+
+    int start = diskStartSector(group);
+    int end = start + group->sectors;
+    for (DiskRequest *req = group; req != NULL; req = req->mergeNext)
+    {
+        int reqStart = diskStartSector(req);
+        if (reqStart < start)
+        {
+            start = reqStart;
+        }
+        if (reqStart + req->sectors > end)
+        {
+            end = reqStart + req->sectors;
+        }
+        req->status = USLOSS_DEV_READY;
+    }
+
+    for (int s = start; s < end; s++)
+    {
+        int track = s / USLOSS_DISK_TRACK_SIZE;
+        int sector = s % USLOSS_DISK_TRACK_SIZE;
+        int status = USLOSS_DEV_READY;
+
+        if (diskHeadTrack[unit] != track)
+        {
+            int from = diskHeadTrack[unit];
+            int started = currentTime();
+            status = diskDeviceOp(unit, USLOSS_DISK_SEEK, (void *)(long)track, NULL);
+            if (status != USLOSS_DEV_READY)
+            {
+                // a failed seek leaves the head somewhere we can't trust
+                diskHeadTrack[unit] = -1;
+            }
+            else
+            {
+                if (from >= 0)
+                {
+                    diskRecordSeek(unit, abs(track - from), currentTime() - started);
+                }
+                diskHeadTrack[unit] = track;
+            }
+        }
+
+        // the device transfers through the first read, or the latest write, covering s
+        DiskRequest *source = NULL;
+        for (DiskRequest *req = group; req != NULL; req = req->mergeNext)
+        {
+            int reqStart = diskStartSector(req);
+            if (s < reqStart || s >= reqStart + req->sectors)
+            {
+                continue;
+            }
+            if (source == NULL || (group->op == USLOSS_DISK_WRITE && req->seq > source->seq) ||
+                (group->op == USLOSS_DISK_READ && req->seq < source->seq))
+            {
+                source = req;
+            }
+        }
+
+        char *buffer = diskSectorBuffer(source, s - diskStartSector(source));
+        if (status == USLOSS_DEV_READY)
+        {
+            int started = currentTime();
+            status = diskDeviceOp(unit, group->op, (void *)(long)sector, buffer);
+            if (status == USLOSS_DEV_READY)
+            {
+                diskRecordTransfer(unit, currentTime() - started);
+            }
+        }
+
+        if (status != USLOSS_DEV_READY)
+        {
+            // everything still waiting on this sector or a later one fails with it
+            for (DiskRequest *req = group; req != NULL; req = req->mergeNext)
+            {
+                if (diskStartSector(req) + req->sectors > s)
+                {
+                    req->status = status;
+                }
+            }
+            return;
+        }
+
+        if (group->op == USLOSS_DISK_READ)
+        {
+            for (DiskRequest *req = group; req != NULL; req = req->mergeNext)
+            {
+                int reqStart = diskStartSector(req);
+                if (req != source && s >= reqStart && s < reqStart + req->sectors)
+                {
+                    memcpy(diskSectorBuffer(req, s - reqStart), buffer, USLOSS_DISK_SECTOR_SIZE);
+                }
+            }
+        }
+    }
+}
+
+/*
+ * Marks a request done, records its service time and wakes its owner
+ * A finished read-ahead instead fills its cache entry and releases its slot
+ *
+ * Parameters:
+ *   req - the finished request
+ *
+ * Returns: void
+ */
+static void diskComplete(DiskRequest *req)
+{
+    kernMutexLock(&disk_lock);
+    DiskUnitStats *stats = &diskStats[req->unit];
+    stats->ops++;
+    stats->queueDepth--;
+    diskHistAdd(stats->serviceHist, currentTime() - req->startTime);
+
+    // a read-ahead has no owner; its data simply becomes visible in the cache
+    DiskCacheTrack *entry = req->cache;
+    if (entry != NULL)
+    {
+        entry->filling = 0;
+        if (entry->stale || req->status != USLOSS_DEV_READY)
+        {
+            entry->valid = 0;
+            entry->unit = -1;
+        }
+        else
+        {
+            entry->valid = DISK_FULL_TRACK_MASK;
+        }
+        req->inUse = 0;
+        kernMutexUnlock(&disk_lock);
+        return;
+    }
+
+    if (req->status == USLOSS_DEV_READY && diskProcs[req->ownerPid % MAXPROC].pid == req->ownerPid)
+    {
+        DiskProcCounters *counters = &diskProcs[req->ownerPid % MAXPROC].counters;
+        if (req->op == USLOSS_DISK_READ)
+        {
+            counters->bytesRead += (long long)req->sectors * USLOSS_DISK_SECTOR_SIZE;
+        }
+        else if (req->op == USLOSS_DISK_WRITE)
+        {
+            counters->bytesWritten += (long long)req->sectors * USLOSS_DISK_SECTOR_SIZE;
+        }
+    }
+
+    req->done = 1;
+    int owner = req->ownerPid;
+    kernMutexUnlock(&disk_lock);
+
+    // the owner rechecks its requests after every wakeup, so one signal covers several completions
+    kernEventSignal(&diskDoneEvents[owner % MAXPROC]);
+}
+
+/*
+ * Looks for a read on the device that covers exactly the same sectors as a new read,
+ * so the new one can share its result instead of being queued
+ * A queued write to any of those sectors rules this out, since the new read
+ * might be meant to see it
+ * Must be called with disk_lock held
+ *
+ * Parameters:
+ *   req - the new read
+ *
+ * Returns:
+ *   DiskRequest * - the in-flight read to attach to, or NULL if there is none
+ */
+static DiskRequest *diskFindInFlight(DiskRequest *req)
+{
+    int start = diskStartSector(req);
+    int end = start + req->sectors;
+
+    for (DiskRequest *cur = diskQueue[req->unit]; cur != NULL; cur = cur->next)
+    {
+        int curStart = diskStartSector(cur);
+        if (cur->op == USLOSS_DISK_WRITE && curStart < end && curStart + cur->sectors > start)
+        {
+            return NULL;
+        }
+    }
+
+    for (DiskRequest *cur = diskActive[req->unit]; cur != NULL; cur = cur->mergeNext)
+    {
+        if (cur->op == USLOSS_DISK_READ && cur->track == req->track &&
+            cur->first == req->first && cur->sectors == req->sectors)
+        {
+            return cur;
+        }
+    }
+    return NULL;
+}
+
+#if DISK_WARM_LIST
+/*
+ * Moves the head to a unit's reserved track and transfers sector 0 of it
+ * Only the unit's driver calls this, between passes
+ *
+ * Parameters:
+ *   unit - the disk unit
+ *   op - USLOSS_DISK_READ or USLOSS_DISK_WRITE
+ *   sector - the sector's USLOSS_DISK_SECTOR_SIZE bytes
+ *
+ * Returns:
+ *   int - the device status
+ */
+static int diskWarmTransfer(int unit, int op, char *sector)
+{
+    int track = diskTracks[unit];
+
+    int status = diskDeviceOp(unit, USLOSS_DISK_SEEK, (void *)(long)track, NULL);
+    if (status != USLOSS_DEV_READY)
+    {
+        diskHeadTrack[unit] = -1;
+        return status;
+    }
+    diskHeadTrack[unit] = track;
+    return diskDeviceOp(unit, op, (void *)0, sector);
+}
+
+/*
+ * Builds the warm list for a unit from its hottest cached tracks
+ * Must be called with disk_lock held
+ *
+ * Parameters:
+ *   unit - the disk unit
+ *   list - receives the list
+ *
+ * Returns: void
+ */
+static void diskWarmCollect(int unit, DiskWarmList *list)
+{
+    int taken[DISK_CACHE_TRACKS] = {0};
+
+    list->magic = DISK_WARM_MAGIC;
+    list->count = 0;
+    while (list->count < DISK_WARM_MAX)
+    {
+        int best = -1;
+        for (int i = 0; i < DISK_CACHE_TRACKS; i++)
+        {
+            DiskCacheTrack *entry = &diskCache[i];
+            if (!taken[i] && entry->unit == unit && entry->lastUse > 0 && entry->valid != 0 &&
+                (best == -1 || entry->lastUse > diskCache[best].lastUse))
+            {
+                best = i;
+            }
+        }
+        if (best == -1)
+        {
+            break;
+        }
+        taken[best] = 1;
+
+        // insertion sort, so the list reads back in elevator order
+        int at = list->count++;
+        while (at > 0 && list->tracks[at - 1] > diskCache[best].track)
+        {
+            list->tracks[at] = list->tracks[at - 1];
+            at--;
+        }
+        list->tracks[at] = diskCache[best].track;
+    }
+}
+
+/*
+ * Rewrites a unit's warm list if its hot tracks have changed since the last write
+ * and DISK_WARM_SAVE_US has passed
+ * Only the unit's driver calls this, while it is idle
+ *
+ * Parameters:
+ *   unit - the disk unit
+ *
+ * Returns: void
+ */
+static void diskWarmSave(int unit)
+{
+    DiskWarmList list;
+    char sector[USLOSS_DISK_SECTOR_SIZE];
+
+    kernMutexLock(&disk_lock);
+    int now = currentTime();
+    if (diskTracks[unit] < 0 || now - diskWarmSaveTime[unit] < DISK_WARM_SAVE_US)
+    {
+        kernMutexUnlock(&disk_lock);
+        return;
+    }
+    diskWarmCollect(unit, &list);
+    kernMutexUnlock(&disk_lock);
+
+    if (list.count == diskWarmSaved[unit].count && diskWarmSaved[unit].magic == DISK_WARM_MAGIC &&
+        memcmp(list.tracks, diskWarmSaved[unit].tracks, list.count * sizeof(int)) == 0)
+    {
+        return;
+    }
+
+    memset(sector, 0, sizeof(sector));
+    memcpy(sector, &list, sizeof(list));
+    if (diskWarmTransfer(unit, USLOSS_DISK_WRITE, sector) == USLOSS_DEV_READY)
+    {
+        diskWarmSaved[unit] = list;
+        diskWarmSaveTime[unit] = now;
+    }
+}
+
+/*
+ * Reads a unit's warm list and queues its tracks into the cache as hot entries
+ * The reads go through the queue like any other request, so the driver sweeps
+ * through them in between the requests processes make
+ * Only the unit's driver calls this, before it takes any requests
+ *
+ * Parameters:
+ *   unit - the disk unit
+ *
+ * Returns: void
+ */
+static void diskWarmLoad(int unit)
+{
+    DiskWarmList list;
+    char sector[USLOSS_DISK_SECTOR_SIZE];
+
+    if (diskTracks[unit] < 0 || diskWarmTransfer(unit, USLOSS_DISK_READ, sector) != USLOSS_DEV_READY)
+    {
+        return;
+    }
+    memcpy(&list, sector, sizeof(list));
+    if (list.magic != DISK_WARM_MAGIC || list.count < 0 || list.count > DISK_WARM_MAX)
+    {
+        return;
+    }
+    // a list naming a track outside the unit is damaged, so none of it is trusted
+    for (int i = 0; i < list.count; i++)
+    {
+        if (list.tracks[i] < 0 || list.tracks[i] >= diskTracks[unit])
+        {
+            return;
+        }
+    }
+
+    kernMutexLock(&disk_lock);
+    diskWarmSaved[unit] = list;
+    diskWarmSaveTime[unit] = currentTime();
+    for (int i = 0; i < list.count; i++)
+    {
+        if (diskPrefetch(unit, list.tracks[i], DISK_ADVICE_WILLNEED))
+        {
+            diskCacheFind(unit, list.tracks[i])->warm = 1;
+            diskStats[unit].warmTracks++;
+        }
+    }
+    kernMutexUnlock(&disk_lock);
+}
+#endif
+
+/*
+ * Handles the disk device driver functionality for a specific disk unit
+ * It repeatedly takes the next request off the unit's queue along with any
+ * requests that can share its device pass, services them, and wakes their owners
+ * When the queue is empty it sleeps until a new request is queued
+ * Before taking any requests it caches the unit's track count, and with
+ * DISK_WARM_LIST it queues the tracks on the unit's warm list
+ *
+ * Parameters:
+ *   arg - a string representing the disk unit number
+ *
+ * Returns:
+ *   int - always returns 0
+ */
+int DiskDeviceDriver(char *arg)
+{
+    int unit = atoi(arg);
+    int tracks = 0;
+
+    if (diskDeviceOp(unit, USLOSS_DISK_TRACKS, &tracks, NULL) == USLOSS_DEV_READY)
+    {
+        kernMutexLock(&disk_lock);
+        diskTracks[unit] = tracks - DISK_WARM_RESERVED;
+        kernMutexUnlock(&disk_lock);
+    }
+
+#if DISK_WARM_LIST
+    diskWarmLoad(unit);
+#endif
+
+    while (1)
+    {
+        kernMutexLock(&disk_lock);
+        DiskRequest *group = diskPickNext(unit);
+        if (group != NULL)
+        {
+            diskMerge(unit, group);
+        }
+        diskActive[unit] = group;
+
+        int now = currentTime();
+        for (DiskRequest *req = group; req != NULL; req = req->mergeNext)
+        {
+            diskQueued(req, now);
+            diskCharge(req);
+        }
+        kernMutexUnlock(&disk_lock);
+
+        if (group == NULL)
+        {
+#if DISK_WARM_LIST
+            diskWarmSave(unit);
+#endif
+            kernEventWait(&diskWakeEvents[unit]);
+            continue;
+        }
+
+        diskService(unit, group);
+
+        // after this no more identical reads can attach to the pass
+        kernMutexLock(&disk_lock);
+        diskActive[unit] = NULL;
+        if (group->op == USLOSS_DISK_READ)
+        {
+            for (DiskRequest *req = group; req != NULL; req = req->mergeNext)
+            {
+                if (req->cache == NULL && req->status == USLOSS_DEV_READY)
+                {
+                    diskCacheAdmit(req);
+                }
+            }
+        }
+        kernMutexUnlock(&disk_lock);
+
+        DiskRequest *next;
+        for (DiskRequest *req = group; req != NULL; req = next)
+        {
+            // once a request is done its owner may release it, so read the links first
+            next = req->mergeNext;
+
+            DiskRequest *dupNext;
+            for (DiskRequest *dup = req->dupNext; dup != NULL; dup = dupNext)
+            {
+                dupNext = dup->dupNext;
+                for (int i = 0; i < req->sectors; i++)
+                {
+                    memcpy(diskSectorBuffer(dup, i), diskSectorBuffer(req, i), USLOSS_DISK_SECTOR_SIZE);
+                }
+                dup->status = req->status;
+                diskComplete(dup);
+            }
+            req->dupNext = NULL;
+
+            diskComplete(req);
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Refills the token buckets of rate-capped processes for the time since the last
+ * refill; a bucket holds at most one second of its process's rate
+ * The disk lock must be held
+ *
+ * Returns: void
+ */
+static void diskRefill(void)
+{
+    int now = currentTime();
+    long long elapsed = now - diskLastRefill;
+    diskLastRefill = now;
+
+    for (int i = 0; i < MAXPROC; i++)
+    {
+        DiskProc *proc = &diskProcs[i];
+        if (proc->pid < 0 || proc->rateCap <= 0)
+        {
+            continue;
+        }
+
+        proc->tokens += proc->rateCap * elapsed;
+        if (proc->tokens > proc->rateCap * DISK_TOKEN_SCALE)
+        {
+            proc->tokens = proc->rateCap * DISK_TOKEN_SCALE;
+        }
+    }
+}
+
+/*
+ * Allocates a request for the current process and queues it on its unit
+ * Asynchronous requests are refused once the process has DISK_MAX_INFLIGHT of them
+ * A single fragment is copied into the request; a longer fragment list is used
+ * in place, so it must stay valid until the request is collected
+ *
+ * Parameters:
+ *   op - USLOSS_DISK_READ, USLOSS_DISK_WRITE or USLOSS_DISK_TRACKS
+ *   iov - the caller's fragments, one sector per USLOSS_DISK_SECTOR_SIZE bytes
+ *   iovCount - the number of fragments
+ *   unit - the disk unit
+ *   track - the first track of the transfer
+ *   first - the first sector on that track
+ *   async - nonzero if the caller will collect the request with kernDiskWait
+ *
+ * Returns:
+ *   int - the request's handle, or -1 if the arguments are invalid or no slot is available;
+ *         a transfer past the end of the unit gets a handle and fails with USLOSS_DEV_ERROR
+ */
+static int diskSubmit(int op, DiskIovec *iov, int iovCount, int unit, int track, int first, int async)
+{
+    int sectors = 0;
+    int pastEnd = 0;
+
+    if (unit < 0 || unit >= USLOSS_DISK_UNITS)
+    {
+        return -1;
+    }
+    driverEnsure(USLOSS_DISK_DEV, unit);
+    if (op != USLOSS_DISK_TRACKS)
+    {
+        if (iov == NULL || iovCount <= 0 || iovCount > DISK_MAX_IOV ||
+            track < 0 || first < 0 || first >= USLOSS_DISK_TRACK_SIZE)
+        {
+            return -1;
+        }
+        for (int i = 0; i < iovCount; i++)
+        {
+            if (iov[i].buffer == NULL || iov[i].sectors <= 0)
+            {
+                return -1;
+            }
+            sectors += iov[i].sectors;
+        }
+
+        // the device itself only fails a track past its real end, and with a warm list
+        // the last real track is the driver's, so the visible end is checked here; the
+        // driver's own warm list I/O goes straight to the device and never comes through
+        int tracks = diskTrackCount(unit);
+        if (tracks < 0)
+        {
+            return -1;
+        }
+        pastEnd = track * USLOSS_DISK_TRACK_SIZE + first + sectors > tracks * USLOSS_DISK_TRACK_SIZE;
+    }
+
+    int cur_pid = getpid();
+
+    kernMutexLock(&disk_lock);
+
+    DiskProc *proc = diskProc(cur_pid);
+    if (op != USLOSS_DISK_TRACKS && proc->rateCap > 0)
+    {
+        // a capped process waits for clock ticks until its bucket has refilled, then may overdraw it
+        diskRefill();
+        if (proc->tokens <= 0)
+        {
+            proc->counters.throttled++;
+        }
+        while (proc->rateCap > 0 && proc->tokens <= 0)
+        {
+            kernMutexUnlock(&disk_lock);
+            kernClockWait();
+            kernMutexLock(&disk_lock);
+            diskRefill();
+        }
+        proc->tokens -= sectors * DISK_TOKEN_SCALE;
+    }
+
+    int inflight = 0;
+    int slot = -1;
+    for (int i = 0; i < DISK_MAX_REQUESTS; i++)
+    {
+        if (!diskRequestTable[i].inUse)
+        {
+            if (slot == -1)
+            {
+                slot = i;
+            }
+        }
+        else if (diskRequestTable[i].ownerPid == cur_pid && diskRequestTable[i].async)
+        {
+            inflight++;
+        }
+    }
+
+    if (slot == -1 || (async && inflight >= DISK_MAX_INFLIGHT))
+    {
+        kernMutexUnlock(&disk_lock);
+        return -1;
+    }
+
+    DiskRequest *req = &diskRequestTable[slot];
+    req->inUse = 1;
+    req->done = 0;
+    req->async = async;
+    req->op = op;
+    req->unit = unit;
+    req->track = track;
+    req->first = first;
+    req->sectors = sectors;
+    if (iovCount == 1)
+    {
+        req->single = iov[0];
+        req->iov = &req->single;
+    }
+    else
+    {
+        req->iov = iov;
+    }
+    req->iovCount = iovCount;
+    req->status = 0;
+    req->ownerPid = cur_pid;
+    req->seq = diskNextSeq++;
+    req->next = NULL;
+    req->mergeNext = NULL;
+    req->dupNext = NULL;
+    req->cache = NULL;
+    req->submitTime = currentTime();
+
+    DiskUnitStats *stats = &diskStats[unit];
+    stats->queueDepth++;
+    if (stats->queueDepth > stats->maxQueueDepth)
+    {
+        stats->maxQueueDepth = stats->queueDepth;
+    }
+
+    if (pastEnd)
+    {
+        // failed as the device fails a track past its end, without reaching it
+        req->status = USLOSS_DEV_ERROR;
+        diskQueued(req, req->submitTime);
+        kernMutexUnlock(&disk_lock);
+        diskComplete(req);
+        return slot;
+    }
+
+    if (op == USLOSS_DISK_WRITE)
+    {
+        diskCacheInvalidate(req);
+    }
+
+    if (op == USLOSS_DISK_READ && diskCacheRead(req))
+    {
+        stats->cacheHits++;
+        diskQueued(req, req->submitTime);
+        kernMutexUnlock(&disk_lock);
+        diskComplete(req);
+        return slot;
+    }
+
+    if (op == USLOSS_DISK_READ)
+    {
+        DiskRequest *leader = diskFindInFlight(req);
+        if (leader != NULL)
+        {
+            req->dupNext = leader->dupNext;
+            leader->dupNext = req;
+            diskStats[unit].dedupHits++;
+            diskQueued(req, req->submitTime);
+            kernMutexUnlock(&disk_lock);
+            return slot;
+        }
+    }
+
+    // a process that had nothing queued can't bank the time it spent idle
+    if (proc->queued[unit]++ == 0 && proc->vtime[unit] < diskFairFloor(unit))
+    {
+        proc->vtime[unit] = diskFairFloor(unit);
+    }
+    diskEnqueue(req);
+
+    // a read in a SEQUENTIAL range queues the following tracks behind it
+    if (op == USLOSS_DISK_READ)
+    {
+        int last = (diskStartSector(req) + sectors - 1) / USLOSS_DISK_TRACK_SIZE;
+        int window = diskAdviceFor(unit, last) == DISK_ADVICE_SEQUENTIAL ? DISK_READAHEAD_TRACKS : 0;
+        for (int t = last + 1; t <= last + window; t++)
+        {
+            if (diskAdviceFor(unit, t) == DISK_ADVICE_SEQUENTIAL)
+            {
+                diskPrefetch(unit, t, DISK_ADVICE_SEQUENTIAL);
+            }
+        }
+    }
+
+    kernMutexUnlock(&disk_lock);
+
+    kernEventSignal(&diskWakeEvents[unit]);
+    return slot;
+}
+
+/*
+ * Waits for one of the current process's requests to finish and releases it
+ * A handle of -1 waits for whichever outstanding request finishes first
+ *
+ * Parameters:
+ *   handle - the request to wait for, or -1 for any
+ *   out - receives a copy of the finished request
+ *
+ * Returns:
+ *   int - the handle of the finished request, or -1 if there is nothing to wait for
+ */
+static int diskCollect(int handle, DiskRequest *out)
+{
+    int cur_pid = getpid();
+
+    if (handle < -1 || handle >= DISK_MAX_REQUESTS)
+    {
+        return -1;
+    }
+
+    while (1)
+    {
+        kernMutexLock(&disk_lock);
+
+        int found = -1;
+        int pending = 0;
+        if (handle != -1)
+        {
+            DiskRequest *req = &diskRequestTable[handle];
+            if (!req->inUse || req->ownerPid != cur_pid)
+            {
+                kernMutexUnlock(&disk_lock);
+                return -1;
+            }
+            pending = 1;
+            if (req->done)
+            {
+                found = handle;
+            }
+        }
+        else
+        {
+            for (int i = 0; i < DISK_MAX_REQUESTS && found == -1; i++)
+            {
+                DiskRequest *req = &diskRequestTable[i];
+                if (req->inUse && req->ownerPid == cur_pid)
+                {
+                    pending = 1;
+                    if (req->done)
+                    {
+                        found = i;
+                    }
+                }
+            }
+        }
+
+        if (found != -1)
+        {
+            *out = diskRequestTable[found];
+            diskRequestTable[found].inUse = 0;
+            kernMutexUnlock(&disk_lock);
+            return found;
+        }
+
+        kernMutexUnlock(&disk_lock);
+
+        if (!pending)
+        {
+            return -1;
+        }
+
+        // completions for other handles also land here, so recheck after every wakeup
+        kernEventWait(&diskDoneEvents[cur_pid % MAXPROC]);
+    }
+}
+
+/*
+ * Returns the number of tracks on a unit
+ * The driver caches this when it starts; a caller that gets here before then
+ * queues a query behind the driver's own
+ * The striped volume has as many tracks as both units together, sized by the smaller one,
+ * and the mirrored volume as many as the smaller unit
+ *
+ * Parameters:
+ *   unit - the disk unit, or a volume pseudo-unit
+ *
+ * Returns:
+ *   int - the track count, or -1 if the unit is invalid or the device could not report it
+ */
+static int diskTrackCount(int unit)
+{
+    DiskRequest done;
+
+    if (DISK_IS_VOLUME(unit))
+    {
+        int tracks0 = diskTrackCount(0);
+        int tracks1 = diskTrackCount(1);
+        if (tracks0 < 0 || tracks1 < 0)
+        {
+            return -1;
+        }
+        int smaller = tracks0 < tracks1 ? tracks0 : tracks1;
+        return unit == DISK_UNIT_STRIPED ? 2 * smaller : smaller;
+    }
+    if (unit < 0 || unit >= USLOSS_DISK_UNITS)
+    {
+        return -1;
+    }
+    if (diskTracks[unit] >= 0)
+    {
+        return diskTracks[unit];
+    }
+
+    int handle = diskSubmit(USLOSS_DISK_TRACKS, NULL, 0, unit, 0, 0, 0);
+    if (handle < 0)
+    {
+        return -1;
+    }
+
+    diskCollect(handle, &done);
+    return done.status == USLOSS_DEV_READY ? done.sectors : -1;
+}
+
+/*
+ * Transfers a run of the striped volume's sectors
+ * Volume sectors are dealt out to disk 0 and disk 1 in turn, DISK_STRIPE_SECTORS at a
+ * time, so the stripes a unit receives sit next to each other on that unit
+ * Each unit's share becomes one vectored request whose fragments are the caller's
+ * stripes, and both requests are queued before either is waited for so the two
+ * drivers work in parallel; a share too fragmented for one request is sent in batches
+ * The caller has already checked the run against the volume's size
+ *
+ * Parameters:
+ *   op - USLOSS_DISK_READ or USLOSS_DISK_WRITE
+ *   buffer - the buffer to transfer to or from
+ *   lba - the first volume sector
+ *   count - the number of sectors
+ *   status - receives the first failing device status, or USLOSS_DEV_READY
+ *
+ * Returns:
+ *   int - returns 0 if the transfer was attempted, -1 if no request could be queued
+ */
+static int diskStriped(int op, char *buffer, int lba, int count, int *status)
+{
+    int pos = 0;
+    int res = 0;
+
+    *status = USLOSS_DEV_READY;
+
+    while (pos < count && res == 0)
+    {
+        DiskIovec iov[USLOSS_DISK_UNITS][DISK_MAX_IOV];
+        int iovCount[USLOSS_DISK_UNITS] = {0};
+        int start[USLOSS_DISK_UNITS] = {0};
+        int handle[USLOSS_DISK_UNITS];
+
+        while (pos < count)
+        {
+            int sector = lba + pos;
+            int stripe = sector / DISK_STRIPE_SECTORS;
+            int unit = stripe % USLOSS_DISK_UNITS;
+            int offset = sector % DISK_STRIPE_SECTORS;
+            int len = DISK_STRIPE_SECTORS - offset;
+            if (len > count - pos)
+            {
+                len = count - pos;
+            }
+
+            if (iovCount[unit] == DISK_MAX_IOV)
+            {
+                break;
+            }
+            if (iovCount[unit] == 0)
+            {
+                start[unit] = (stripe / USLOSS_DISK_UNITS) * DISK_STRIPE_SECTORS + offset;
+            }
+            iov[unit][iovCount[unit]].buffer = buffer + pos * USLOSS_DISK_SECTOR_SIZE;
+            iov[unit][iovCount[unit]].sectors = len;
+            iovCount[unit]++;
+            pos += len;
+        }
+
+        for (int unit = 0; unit < USLOSS_DISK_UNITS; unit++)
+        {
+            handle[unit] = -1;
+            if (iovCount[unit] > 0)
+            {
+                handle[unit] = diskSubmit(op, iov[unit], iovCount[unit], unit,
+                                          start[unit] / USLOSS_DISK_TRACK_SIZE,
+                                          start[unit] % USLOSS_DISK_TRACK_SIZE, 0);
+                if (handle[unit] < 0)
+                {
+                    res = -1;
+                }
+            }
+        }
+
+        // the fragment lists live on this stack, so both requests must finish here
+        for (int unit = 0; unit < USLOSS_DISK_UNITS; unit++)
+        {
+            DiskRequest done;
+            if (handle[unit] >= 0)
+            {
+                diskCollect(handle[unit], &done);
+                if (done.status != USLOSS_DEV_READY && *status == USLOSS_DEV_READY)
+                {
+                    *status = done.status;
+                }
+            }
+        }
+    }
+
+    return res;
+}
+
+/*
+ * Counts the requests a unit's driver has to get through, including the pass it is on
+ * Must be called with disk_lock held
+ *
+ * Parameters:
+ *   unit - the disk unit
+ *
+ * Returns:
+ *   int - the number of queued requests, plus one if the driver is busy
+ */
+static int diskQueueDepth(int unit)
+{
+    int depth = diskActive[unit] != NULL ? 1 : 0;
+    for (DiskRequest *cur = diskQueue[unit]; cur != NULL; cur = cur->next)
+    {
+        depth++;
+    }
+    return depth;
+}
+
+/*
+ * Transfers a run of the mirrored volume's sectors, which sit at the same place on both units
+ * A write is queued on both units before either is waited for
+ * A read goes to the unit with fewer requests ahead of it, or, if the queues are
+ * equal, the one whose head is nearer the first track; a head that has not been
+ * placed yet, or was lost to a failed seek, counts as farther than any known one
+ *
+ * Parameters:
+ *   op - USLOSS_DISK_READ or USLOSS_DISK_WRITE
+ *   buffer - the buffer to transfer to or from
+ *   lba - the first volume sector
+ *   count - the number of sectors
+ *   status - receives the first failing device status, or USLOSS_DEV_READY
+ *
+ * Returns:
+ *   int - returns 0 if the transfer was attempted, -1 if no request could be queued
+ */
+static int diskMirrored(int op, char *buffer, int lba, int count, int *status)
+{
+    DiskIovec iov = {buffer, count};
+    int track = lba / USLOSS_DISK_TRACK_SIZE;
+    int first = lba % USLOSS_DISK_TRACK_SIZE;
+    int handle[USLOSS_DISK_UNITS];
+    int res = 0;
+
+    for (int unit = 0; unit < USLOSS_DISK_UNITS; unit++)
+    {
+        handle[unit] = -1;
+    }
+
+    if (op == USLOSS_DISK_READ)
+    {
+        int distance[USLOSS_DISK_UNITS];
+        int depth[USLOSS_DISK_UNITS];
+
+        kernMutexLock(&disk_lock);
+        for (int unit = 0; unit < USLOSS_DISK_UNITS; unit++)
+        {
+            // an unknown head position (-1) has to seek no matter where the track is,
+            // and the unit may not even be sized yet, so it has no distance
+            int head = diskHeadTrack[unit];
+            distance[unit] = head < 0 ? -1 : abs(head - track);
+            depth[unit] = diskQueueDepth(unit);
+        }
+
+        int nearer = distance[1] >= 0 && (distance[0] < 0 || distance[1] < distance[0]);
+        int chosen = 0;
+        if (depth[1] < depth[0] || (depth[1] == depth[0] && nearer))
+        {
+            chosen = 1;
+        }
+        diskStats[chosen].mirrorReads++;
+        if (distance[chosen] >= 0 && distance[1 - chosen] > distance[chosen])
+        {
+            diskStats[chosen].mirrorSeekSaved += distance[1 - chosen] - distance[chosen];
+        }
+        kernMutexUnlock(&disk_lock);
+
+        handle[chosen] = diskSubmit(op, &iov, 1, chosen, track, first, 0);
+        if (handle[chosen] < 0)
+        {
+            res = -1;
+        }
+    }
+    else
+    {
+        for (int unit = 0; unit < USLOSS_DISK_UNITS; unit++)
+        {
+            handle[unit] = diskSubmit(op, &iov, 1, unit, track, first, 0);
+            if (handle[unit] < 0)
+            {
+                res = -1;
+            }
+        }
+    }
+
+    *status = USLOSS_DEV_READY;
+    for (int unit = 0; unit < USLOSS_DISK_UNITS; unit++)
+    {
+        DiskRequest done;
+        if (handle[unit] >= 0)
+        {
+            diskCollect(handle[unit], &done);
+            if (done.status != USLOSS_DEV_READY && *status == USLOSS_DEV_READY)
+            {
+                *status = done.status;
+            }
+        }
+    }
+
+    return res;
+}
+
+/*
+ * Transfers a run of a volume's sectors, already checked against the volume's size
+ *
+ * Parameters:
+ *   op - USLOSS_DISK_READ or USLOSS_DISK_WRITE
+ *   buffer - the buffer to transfer to or from
+ *   unit - DISK_UNIT_STRIPED or DISK_UNIT_MIRRORED
+ *   lba - the first volume sector
+ *   count - the number of sectors
+ *   status - receives the device status of the transfer
+ *
+ * Returns:
+ *   int - returns 0 if the transfer was attempted, -1 if no request could be queued
+ */
+static int diskVolumeRun(int op, char *buffer, int unit, int lba, int count, int *status)
+{
+    if (unit == DISK_UNIT_STRIPED)
+    {
+        return diskStriped(op, buffer, lba, count, status);
+    }
+    return diskMirrored(op, buffer, lba, count, status);
+}
+
+/*
+ * Transfers sectors of a volume addressed by track and sector, like the physical units
+ * A transfer that runs past the end of the volume is attempted but fails with
+ * USLOSS_DEV_ERROR, just as it would on a physical unit
+ *
+ * Parameters:
+ *   op - USLOSS_DISK_READ or USLOSS_DISK_WRITE
+ *   diskBuffer - the buffer to transfer to or from
+ *   unit - the volume's pseudo-unit number
+ *   track - the first track of the transfer
+ *   first - the first sector on that track
+ *   sectors - the number of sectors
+ *   status - receives the device status of the transfer
+ *
+ * Returns:
+ *   int - returns 0 if the transfer was attempted, -1 if invalid parameters are provided
+ */
+static int diskVolume(int op, void *diskBuffer, int unit, int track, int first, int sectors, int *status)
+{
+    int tracks = diskTrackCount(unit);
+    if (tracks < 0 || diskBuffer == NULL || track < 0 || first < 0 ||
+        first >= USLOSS_DISK_TRACK_SIZE || sectors <= 0)
+    {
+        return -1;
+    }
+
+    int lba = track * USLOSS_DISK_TRACK_SIZE + first;
+    if (lba + sectors > tracks * USLOSS_DISK_TRACK_SIZE)
+    {
+        *status = USLOSS_DEV_ERROR;
+        return 0;
+    }
+
+    return diskVolumeRun(op, diskBuffer, unit, lba, sectors, status);
+}
+
+/*
+ * Reads sectors from a disk unit into the provided buffer, blocking until done
+ *
+ * Parameters:
+ *   diskBuffer - the buffer to read into
+ *   unit - the disk unit, or a volume pseudo-unit
+ *   track - the first track to read
+ *   first - the first sector to read on that track
+ *   sectors - the number of sectors to read
+ *   status - receives the device status of the transfer
+ *
+ * Returns:
+ *   int - returns 0 if the transfer was attempted, -1 if invalid parameters are provided
+ */
+int kernDiskRead(void *diskBuffer, int unit, int track, int first, int sectors, int *status)
+{
+    DiskRequest done;
+    DiskIovec iov = {diskBuffer, sectors};
+
+    if (DISK_IS_VOLUME(unit))
+    {
+        return diskVolume(USLOSS_DISK_READ, diskBuffer, unit, track, first, sectors, status);
+    }
+
+    int handle = diskSubmit(USLOSS_DISK_READ, &iov, 1, unit, track, first, 0);
+    if (handle < 0)
+    {
+        return -1;
+    }
+
+    diskCollect(handle, &done);
+    *status = done.status;
+    return 0;
+}
+
+/*
+ * Writes sectors from the provided buffer to a disk unit, blocking until done
+ *
+ * Parameters:
+ *   diskBuffer - the buffer to write from
+ *   unit - the disk unit, or a volume pseudo-unit
+ *   track - the first track to write
+ *   first - the first sector to write on that track
+ *   sectors - the number of sectors to write
+ *   status - receives the device status of the transfer
+ *
+ * Returns:
+ *   int - returns 0 if the transfer was attempted, -1 if invalid parameters are provided
+ */
+int kernDiskWrite(void *diskBuffer, int unit, int track, int first, int sectors, int *status)
+{
+    DiskRequest done;
+    DiskIovec iov = {diskBuffer, sectors};
+
+    if (DISK_IS_VOLUME(unit))
+    {
+        return diskVolume(USLOSS_DISK_WRITE, diskBuffer, unit, track, first, sectors, status);
+    }
+
+    int handle = diskSubmit(USLOSS_DISK_WRITE, &iov, 1, unit, track, first, 0);
+    if (handle < 0)
+    {
+        return -1;
+    }
+
+    diskCollect(handle, &done);
+    *status = done.status;
+    return 0;
+}
+
+/*
+ * Reads a contiguous run of sectors into several separate buffers, blocking until done
+ * The sectors fill the fragments in order, each fragment taking as many as it lists
+ *
+ * Parameters:
+ *   iov - the fragments to read into
+ *   iovCount - the number of fragments, at most DISK_MAX_IOV
+ *   unit - the disk unit
+ *   track - the first track to read
+ *   first - the first sector to read on that track
+ *   status - receives the device status of the transfer
+ *
+ * Returns:
+ *   int - returns 0 if the transfer was attempted, -1 if invalid parameters are provided
+ */
+int kernDiskReadv(DiskIovec *iov, int iovCount, int unit, int track, int first, int *status)
+{
+    DiskRequest done;
+
+    int handle = diskSubmit(USLOSS_DISK_READ, iov, iovCount, unit, track, first, 0);
+    if (handle < 0)
+    {
+        return -1;
+    }
+
+    diskCollect(handle, &done);
+    *status = done.status;
+    return 0;
+}
+
+/*
+ * Writes several separate buffers to a contiguous run of sectors, blocking until done
+ * The fragments are written in order, each supplying as many sectors as it lists
+ *
+ * Parameters:
+ *   iov - the fragments to write from
+ *   iovCount - the number of fragments, at most DISK_MAX_IOV
+ *   unit - the disk unit
+ *   track - the first track to write
+ *   first - the first sector to write on that track
+ *   status - receives the device status of the transfer
+ *
+ * Returns:
+ *   int - returns 0 if the transfer was attempted, -1 if invalid parameters are provided
+ */
+int kernDiskWritev(DiskIovec *iov, int iovCount, int unit, int track, int first, int *status)
+{
+    DiskRequest done;
+
+    int handle = diskSubmit(USLOSS_DISK_WRITE, iov, iovCount, unit, track, first, 0);
+    if (handle < 0)
+    {
+        return -1;
+    }
+
+    diskCollect(handle, &done);
+    *status = done.status;
+    return 0;
+}
+
+/*
+ * Queues a read without waiting for it; the buffer must stay valid until kernDiskWait
+ *
+ * Parameters:
+ *   diskBuffer, unit, track, first, sectors - as for kernDiskRead
+ *   handle - receives the handle to pass to kernDiskWait
+ *
+ * Returns:
+ *   int - returns 0 on success, -1 if invalid parameters are provided or too many requests are outstanding
+ */
+int kernDiskReadAsync(void *diskBuffer, int unit, int track, int first, int sectors, int *handle)
+{
+    DiskIovec iov = {diskBuffer, sectors};
+
+    *handle = diskSubmit(USLOSS_DISK_READ, &iov, 1, unit, track, first, 1);
+    return *handle < 0 ? -1 : 0;
+}
+
+/*
+ * Queues a write without waiting for it; the buffer must stay valid until kernDiskWait
+ *
+ * Parameters:
+ *   diskBuffer, unit, track, first, sectors - as for kernDiskWrite
+ *   handle - receives the handle to pass to kernDiskWait
+ *
+ * Returns:
+ *   int - returns 0 on success, -1 if invalid parameters are provided or too many requests are outstanding
+ */
+int kernDiskWriteAsync(void *diskBuffer, int unit, int track, int first, int sectors, int *handle)
+{
+    DiskIovec iov = {diskBuffer, sectors};
+
+    *handle = diskSubmit(USLOSS_DISK_WRITE, &iov, 1, unit, track, first, 1);
+    return *handle < 0 ? -1 : 0;
+}
+
+/*
+ * Waits for an asynchronous request to finish and releases its handle
+ *
+ * Parameters:
+ *   handle - the handle to wait for, or -1 to wait for any outstanding request;
+ *            receives the handle that finished
+ *   status - receives the device status of the transfer
+ *
+ * Returns:
+ *   int - returns 0 on success, -1 if the handle is not an outstanding request of this process
+ */
+int kernDiskWait(int *handle, int *status)
+{
+    DiskRequest done;
+
+    int finished = diskCollect(*handle, &done);
+    if (finished < 0)
+    {
+        return -1;
+    }
+
+    *handle = finished;
+    *status = done.status;
+    return 0;
+}
+
+/*
+ * Waits for whichever of a set of the current process's requests finishes first
+ * and releases it
+ * Entries of -1 in the set are skipped
+ *
+ * Parameters:
+ *   handles - the handles to wait for
+ *   count - the number of entries in handles
+ *   index - receives the position in handles of the request that finished
+ *   status - receives its device status
+ *
+ * Returns:
+ *   int - returns 0 if a request finished, -1 if none of the handles is outstanding
+ */
+int kernDiskWaitAny(int *handles, int count, int *index, int *status)
+{
+    int cur_pid = getpid();
+
+    while (1)
+    {
+        int pending = 0;
+
+        kernMutexLock(&disk_lock);
+        for (int i = 0; i < count; i++)
+        {
+            if (handles[i] < 0 || handles[i] >= DISK_MAX_REQUESTS)
+            {
+                continue;
+            }
+
+            DiskRequest *req = &diskRequestTable[handles[i]];
+            if (!req->inUse || req->ownerPid != cur_pid)
+            {
+                continue;
+            }
+            pending = 1;
+            if (req->done)
+            {
+                *index = i;
+                *status = req->status;
+                req->inUse = 0;
+                kernMutexUnlock(&disk_lock);
+                return 0;
+            }
+        }
+        kernMutexUnlock(&disk_lock);
+
+        if (!pending)
+        {
+            return -1;
+        }
+        kernEventWait(&diskDoneEvents[cur_pid % MAXPROC]);
+    }
+}
+
+/*
+ * Transfers a run of logical sectors, numbered across the whole unit from 0
+ * The run becomes a single request, so the driver seeks once per track it touches
+ *
+ * Parameters:
+ *   op - USLOSS_DISK_READ or USLOSS_DISK_WRITE
+ *   diskBuffer - the buffer to transfer to or from
+ *   unit - the disk unit, or a volume pseudo-unit
+ *   lba - the first logical sector
+ *   count - the number of sectors
+ *   status - receives the device status of the transfer
+ *
+ * Returns:
+ *   int - returns 0 if the transfer was attempted, -1 if invalid parameters are provided
+ */
+static int diskBlocks(int op, void *diskBuffer, int unit, int lba, int count, int *status)
+{
+    DiskRequest done;
+    DiskIovec iov = {diskBuffer, count};
+
+    int tracks = diskTrackCount(unit);
+    if (tracks < 0 || lba < 0 || count <= 0 || lba + count > tracks * USLOSS_DISK_TRACK_SIZE)
+    {
+        return -1;
+    }
+
+    if (DISK_IS_VOLUME(unit))
+    {
+        return diskVolumeRun(op, diskBuffer, unit, lba, count, status);
+    }
+
+    int handle = diskSubmit(op, &iov, 1, unit, lba / USLOSS_DISK_TRACK_SIZE,
+                            lba % USLOSS_DISK_TRACK_SIZE, 0);
+    if (handle < 0)
+    {
+        return -1;
+    }
+
+    diskCollect(handle, &done);
+    *status = done.status;
+    return 0;
+}
+
+/*
+ * Reads a run of logical sectors into the provided buffer, blocking until done
+ * Unlike the track and sector calls, which attempt a run past the end and report
+ * USLOSS_DEV_ERROR, a run past the end is refused as an invalid argument
+ *
+ * Parameters:
+ *   diskBuffer - the buffer to read into
+ *   unit - the disk unit, or a volume pseudo-unit
+ *   lba - the first logical sector, track * USLOSS_DISK_TRACK_SIZE + sector
+ *   count - the number of sectors to read
+ *   status - receives the device status of the transfer
+ *
+ * Returns:
+ *   int - returns 0 if the transfer was attempted, -1 if invalid parameters are provided
+ *         or the run goes past the end of the unit
+ */
+int kernDiskReadBlocks(void *diskBuffer, int unit, int lba, int count, int *status)
+{
+    return diskBlocks(USLOSS_DISK_READ, diskBuffer, unit, lba, count, status);
+}
+
+/*
+ * Writes a run of logical sectors from the provided buffer, blocking until done
+ * Unlike the track and sector calls, which attempt a run past the end and report
+ * USLOSS_DEV_ERROR, a run past the end is refused as an invalid argument
+ *
+ * Parameters:
+ *   diskBuffer - the buffer to write from
+ *   unit - the disk unit, or a volume pseudo-unit
+ *   lba - the first logical sector, track * USLOSS_DISK_TRACK_SIZE + sector
+ *   count - the number of sectors to write
+ *   status - receives the device status of the transfer
+ *
+ * Returns:
+ *   int - returns 0 if the transfer was attempted, -1 if invalid parameters are provided
+ *         or the run goes past the end of the unit
+ */
+int kernDiskWriteBlocks(void *diskBuffer, int unit, int lba, int count, int *status)
+{
+    return diskBlocks(USLOSS_DISK_WRITE, diskBuffer, unit, lba, count, status);
+}
+
+/*
+ * Reports the geometry of a disk unit from the cached track count
+ *
+ * Parameters:
+ *   unit - the disk unit, or a volume pseudo-unit
+ *   sector - receives the number of bytes in a sector
+ *   track - receives the number of sectors in a track
+ *   disk - receives the number of tracks on the disk
+ *
+ * Returns:
+ *   int - returns 0 on success, -1 if the unit is invalid
+ */
+int kernDiskSize(int unit, int *sector, int *track, int *disk)
+{
+    int tracks = diskTrackCount(unit);
+    if (tracks < 0)
+    {
+        return -1;
+    }
+
+    *sector = USLOSS_DISK_SECTOR_SIZE;
+    *track = USLOSS_DISK_TRACK_SIZE;
+    *disk = tracks;
+    return 0;
+}
+
+/*
+ * Claims a free pair of DiskCopy track buffers, waiting until one is given back
+ * if every pair is in use
+ *
+ * Returns:
+ *   int - the slot index into diskCopyBuffers
+ */
+static int diskCopySlotTake(void)
+{
+    while (1)
+    {
+        kernMutexLock(&disk_lock);
+        for (int slot = 0; slot < DISK_COPY_SLOTS; slot++)
+        {
+            if (!(diskCopySlotsBusy & (1 << slot)))
+            {
+                diskCopySlotsBusy |= 1 << slot;
+                kernMutexUnlock(&disk_lock);
+                return slot;
+            }
+        }
+        kernMutexUnlock(&disk_lock);
+
+        // a slot given back before this wait leaves the event signalled
+        kernEventWait(&diskCopySlotEvent);
+    }
+}
+
+/*
+ * Gives back a pair of DiskCopy track buffers and wakes one waiting copy
+ *
+ * Parameters:
+ *   slot - the slot from diskCopySlotTake
+ *
+ * Returns: void
+ */
+static void diskCopySlotGive(int slot)
+{
+    kernMutexLock(&disk_lock);
+    diskCopySlotsBusy &= ~(1 << slot);
+    kernMutexUnlock(&disk_lock);
+
+    kernEventSignal(&diskCopySlotEvent);
+}
+
+/*
+ * Copies a run of logical sectors from one unit to another, or within one unit,
+ * entirely inside the kernel
+ * The copy moves a track's worth of sectors at a time through a pair of kernel
+ * track buffers: the read of each chunk is queued before the write of the previous
+ * chunk is waited for, so with two units both drivers are busy at once
+ * When the destination overlaps the source further along the same unit the chunks
+ * are copied from the end backward, so no sector is overwritten before it is read
+ *
+ * Parameters:
+ *   srcUnit - the unit to copy from
+ *   srcLBA - the first logical sector to copy
+ *   dstUnit - the unit to copy to
+ *   dstLBA - the first logical sector to write
+ *   count - the number of sectors
+ *   status - receives the first failing device status, USLOSS_DEV_ERROR if a request
+ *            could not be queued, or USLOSS_DEV_READY
+ *
+ * Returns:
+ *   int - returns 0 if the copy was attempted, -1 if invalid parameters are provided
+ */
+int kernDiskCopy(int srcUnit, int srcLBA, int dstUnit, int dstLBA, int count, int *status)
+{
+    if (srcUnit < 0 || srcUnit >= USLOSS_DISK_UNITS || dstUnit < 0 || dstUnit >= USLOSS_DISK_UNITS)
+    {
+        return -1;
+    }
+
+    int srcSectors = diskTrackCount(srcUnit) * USLOSS_DISK_TRACK_SIZE;
+    int dstSectors = diskTrackCount(dstUnit) * USLOSS_DISK_TRACK_SIZE;
+    if (count <= 0 || srcLBA < 0 || dstLBA < 0 || srcLBA + count > srcSectors ||
+        dstLBA + count > dstSectors)
+    {
+        return -1;
+    }
+
+    int slot = diskCopySlotTake();
+
+    int chunks = (count + USLOSS_DISK_TRACK_SIZE - 1) / USLOSS_DISK_TRACK_SIZE;
+    int backward = srcUnit == dstUnit && dstLBA > srcLBA && dstLBA < srcLBA + count;
+    int writeHandle = -1;
+    DiskRequest done;
+
+    *status = USLOSS_DEV_READY;
+
+    for (int step = 0; step < chunks && *status == USLOSS_DEV_READY; step++)
+    {
+        int chunk = backward ? chunks - 1 - step : step;
+        int offset = chunk * USLOSS_DISK_TRACK_SIZE;
+        int len = count - offset < USLOSS_DISK_TRACK_SIZE ? count - offset : USLOSS_DISK_TRACK_SIZE;
+        DiskIovec iov = {diskCopyBuffers[slot][step % 2], len};
+
+        int readHandle = diskSubmit(USLOSS_DISK_READ, &iov, 1, srcUnit,
+                                    (srcLBA + offset) / USLOSS_DISK_TRACK_SIZE,
+                                    (srcLBA + offset) % USLOSS_DISK_TRACK_SIZE, 0);
+
+        // the previous chunk's write runs while this chunk is being read
+        if (writeHandle >= 0)
+        {
+            diskCollect(writeHandle, &done);
+            writeHandle = -1;
+            if (done.status != USLOSS_DEV_READY)
+            {
+                *status = done.status;
+            }
+        }
+
+        // the arguments were checked above, so only a full request table refuses it
+        if (readHandle < 0)
+        {
+            if (*status == USLOSS_DEV_READY)
+            {
+                *status = USLOSS_DEV_ERROR;
+            }
+            break;
+        }
+        diskCollect(readHandle, &done);
+        if (done.status != USLOSS_DEV_READY && *status == USLOSS_DEV_READY)
+        {
+            *status = done.status;
+        }
+        if (*status != USLOSS_DEV_READY)
+        {
+            break;
+        }
+
+        writeHandle = diskSubmit(USLOSS_DISK_WRITE, &iov, 1, dstUnit,
+                                 (dstLBA + offset) / USLOSS_DISK_TRACK_SIZE,
+                                 (dstLBA + offset) % USLOSS_DISK_TRACK_SIZE, 0);
+        if (writeHandle < 0)
+        {
+            *status = USLOSS_DEV_ERROR;
+            break;
+        }
+    }
+
+    if (writeHandle >= 0)
+    {
+        diskCollect(writeHandle, &done);
+        if (done.status != USLOSS_DEV_READY && *status == USLOSS_DEV_READY)
+        {
+            *status = done.status;
+        }
+    }
+
+    diskCopySlotGive(slot);
+    return 0;
+}
+
+/*
+ * Writes zeros over a range of sectors without a user buffer
+ * The range is cut at track boundaries and every piece writes from the same
+ * kernel zero track.  Up to DISK_MAX_INFLIGHT pieces are queued before any is
+ * waited for, so the driver orders them by its sweep and merges neighbours into
+ * multi-track passes.  A volume is zeroed a track at a time through its own path
+ *
+ * Parameters:
+ *   unit - the disk unit, or a volume pseudo-unit
+ *   track - the first track to zero
+ *   first - the first sector on that track
+ *   sectors - the number of sectors to zero
+ *   status - receives the first failing device status, USLOSS_DEV_ERROR if a request
+ *            could not be queued, or USLOSS_DEV_READY
+ *
+ * Returns:
+ *   int - returns 0 if the wipe was attempted, -1 if invalid parameters are provided
+ *         or the range runs past the end of the unit
+ */
+int kernDiskZero(int unit, int track, int first, int sectors, int *status)
+{
+    int tracks = diskTrackCount(unit);
+    if (tracks < 0 || track < 0 || first < 0 || first >= USLOSS_DISK_TRACK_SIZE || sectors <= 0)
+    {
+        return -1;
+    }
+
+    int lba = track * USLOSS_DISK_TRACK_SIZE + first;
+    int end = lba + sectors;
+    if (end > tracks * USLOSS_DISK_TRACK_SIZE)
+    {
+        return -1;
+    }
+
+    int handles[DISK_MAX_INFLIGHT];
+    int pending = 0;
+    int res = 0;
+    DiskRequest done;
+
+    *status = USLOSS_DEV_READY;
+
+    while (lba < end && *status == USLOSS_DEV_READY && res == 0)
+    {
+        int len = USLOSS_DISK_TRACK_SIZE - lba % USLOSS_DISK_TRACK_SIZE;
+        if (len > end - lba)
+        {
+            len = end - lba;
+        }
+
+        if (DISK_IS_VOLUME(unit))
+        {
+            res = diskVolumeRun(USLOSS_DISK_WRITE, diskZeroTrack, unit, lba, len, status);
+        }
+        else
+        {
+            DiskIovec iov = {diskZeroTrack, len};
+            int handle = diskSubmit(USLOSS_DISK_WRITE, &iov, 1, unit, lba / USLOSS_DISK_TRACK_SIZE,
+                                    lba % USLOSS_DISK_TRACK_SIZE, 0);
+            // the range was checked above, so only a full request table refuses it
+            if (handle < 0)
+            {
+                *status = USLOSS_DEV_ERROR;
+            }
+            else
+            {
+                handles[pending++] = handle;
+            }
+        }
+        lba += len;
+
+        // collect a full window, or whatever is left once the range is queued
+        if (pending == DISK_MAX_INFLIGHT ||
+            (pending > 0 && (lba >= end || res != 0 || *status != USLOSS_DEV_READY)))
+        {
+            for (int i = 0; i < pending; i++)
+            {
+                diskCollect(handles[i], &done);
+                if (done.status != USLOSS_DEV_READY && *status == USLOSS_DEV_READY)
+                {
+                    *status = done.status;
+                }
+            }
+            pending = 0;
+        }
+    }
+
+    return res;
+}
+
+/*
+ * Records how a range of tracks is going to be used
+ * The newest advice for a track wins.  WILLNEED also queues reads of the range
+ * into the cache, and DONTNEED drops whatever of the range is cached
+ *
+ * Parameters:
+ *   unit - the disk unit
+ *   track - the first track of the range
+ *   tracks - the number of tracks in the range
+ *   hint - one of the DISK_ADVICE_ values
+ *
+ * Returns:
+ *   int - returns 0 if the advice was recorded, -1 if invalid parameters are provided
+ */
+int kernDiskAdvise(int unit, int track, int tracks, int hint)
+{
+    if (unit < 0 || unit >= USLOSS_DISK_UNITS || track < 0 || tracks <= 0 ||
+        hint < DISK_ADVICE_NORMAL || hint > DISK_ADVICE_DONTNEED)
+    {
+        return -1;
+    }
+
+    int count = diskTrackCount(unit);
+    if (count < 0 || track + tracks > count)
+    {
+        return -1;
+    }
+
+    kernMutexLock(&disk_lock);
+
+    // ranges the new one covers completely can never be consulted again
+    DiskAdviceRange *ranges = diskAdvice[unit];
+    int kept = 0;
+    for (int i = 0; i < diskAdviceCount[unit]; i++)
+    {
+        if (ranges[i].start < track || ranges[i].end > track + tracks)
+        {
+            ranges[kept++] = ranges[i];
+        }
+    }
+    if (kept == DISK_ADVICE_RANGES)
+    {
+        memmove(&ranges[0], &ranges[1], (DISK_ADVICE_RANGES - 1) * sizeof(DiskAdviceRange));
+        kept--;
+    }
+    ranges[kept].start = track;
+    ranges[kept].end = track + tracks;
+    ranges[kept].hint = hint;
+    diskAdviceCount[unit] = kept + 1;
+
+    int queued = 0;
+    for (int t = track; t < track + tracks; t++)
+    {
+        DiskCacheTrack *entry = diskCacheFind(unit, t);
+        if (hint == DISK_ADVICE_DONTNEED && entry != NULL)
+        {
+            diskCacheDrop(entry);
+        }
+        else if (hint == DISK_ADVICE_WILLNEED)
+        {
+            queued |= diskPrefetch(unit, t, hint);
+        }
+    }
+
+    kernMutexUnlock(&disk_lock);
+
+    if (queued)
+    {
+        kernEventSignal(&diskWakeEvents[unit]);
+    }
+    return 0;
+}
+
+/*
+ * Sets a process's share of the disks and its transfer rate cap
+ * A process with twice the share of another is served twice the sectors while
+ * both have requests queued
+ * Another process can only be set if its record slot is its own or unused; a slot
+ * held by a different pid may belong to a live process with requests queued, and
+ * is never reset on its behalf
+ *
+ * Parameters:
+ *   pid - the process, or -1 for the calling process
+ *   share - its weight, from 1 to DISK_MAX_SHARE
+ *   rateCap - the sectors per second it may transfer, or 0 for no cap
+ *
+ * Returns:
+ *   int - returns 0 on success, -1 if invalid parameters are provided or pid's
+ *         slot is held by another process
+ */
+int kernDiskSetShare(int pid, int share, int rateCap)
+{
+    int cur_pid = getpid();
+
+    if (pid == -1)
+    {
+        pid = cur_pid;
+    }
+    if (pid <= 0 || share < 1 || share > DISK_MAX_SHARE || rateCap < 0)
+    {
+        return -1;
+    }
+
+    // a capped process waits on clock ticks for its bucket to refill
+    if (rateCap > 0)
+    {
+        driverEnsure(USLOSS_CLOCK_DEV, 0);
+    }
+
+    kernMutexLock(&disk_lock);
+    // no two live processes share a slot, so the caller's own slot can only hold one that has gone
+    int held = diskProcs[pid % MAXPROC].pid;
+    if (pid != cur_pid && held != pid && held != -1)
+    {
+        kernMutexUnlock(&disk_lock);
+        return -1;
+    }
+    DiskProc *proc = diskProc(pid);
+    proc->share = share;
+    proc->counters.share = share;
+    if (rateCap != proc->rateCap)
+    {
+        proc->rateCap = rateCap;
+        proc->counters.rateCap = rateCap;
+        proc->tokens = rateCap * DISK_TOKEN_SCALE;
+    }
+    kernMutexUnlock(&disk_lock);
+
+    // a process waiting for tokens rechecks its new cap on the next clock tick
+    return 0;
+}
+
+/*
+ * Copies out a process's disk share, rate cap and transfer totals
+ * A process that has never used the disks reports the defaults and zero totals
+ *
+ * Parameters:
+ *   pid - the process, or -1 for the calling process
+ *   counters - receives the values
+ *
+ * Returns:
+ *   int - returns 0 on success, -1 if invalid parameters are provided
+ */
+int kernDiskProcStats(int pid, DiskProcCounters *counters)
+{
+    if (pid == -1)
+    {
+        pid = getpid();
+    }
+    if (pid <= 0 || counters == NULL)
+    {
+        return -1;
+    }
+
+    kernMutexLock(&disk_lock);
+    if (diskProcs[pid % MAXPROC].pid == pid)
+    {
+        *counters = diskProcs[pid % MAXPROC].counters;
+    }
+    else
+    {
+        memset(counters, 0, sizeof(DiskProcCounters));
+        counters->pid = pid;
+        counters->share = DISK_DEFAULT_SHARE;
+    }
+    kernMutexUnlock(&disk_lock);
+    return 0;
+}
+
+/*
+ * Copies out the cost model the driver has fitted for a unit
+ *
+ * Parameters:
+ *   unit - the disk unit
+ *   model - receives the model
+ *
+ * Returns:
+ *   int - returns 0 on success, -1 if the unit is invalid or model is NULL
+ */
+int kernDiskGetModel(int unit, DiskCostModel *model)
+{
+    if (unit < 0 || unit >= USLOSS_DISK_UNITS || model == NULL)
+    {
+        return -1;
+    }
+
+    kernMutexLock(&disk_lock);
+    *model = diskModel[unit];
+    kernMutexUnlock(&disk_lock);
+    return 0;
+}
+
+/*
+ * Copies out the counters the disk subsystem keeps for a unit
+ *
+ * Parameters:
+ *   unit - the disk unit
+ *   stats - receives the counters
+ *
+ * Returns:
+ *   int - returns 0 on success, -1 if the unit is invalid or stats is NULL
+ */
+int kernDiskStats(int unit, DiskUnitStats *stats)
+{
+    if (unit < 0 || unit >= USLOSS_DISK_UNITS || stats == NULL)
+    {
+        return -1;
+    }
+
+    kernMutexLock(&disk_lock);
+    *stats = diskStats[unit];
+    kernMutexUnlock(&disk_lock);
+    return 0;
+}
+
+/*
+ * Prints every unit's disk counters and histograms to the console
+ * Meant to be called by a testcase when it finishes
+ *
+ * Returns: void
+ */
+void dumpDiskStats(void)
+{
+    for (int unit = 0; unit < USLOSS_DISK_UNITS; unit++)
+    {
+        DiskUnitStats stats;
+        kernDiskStats(unit, &stats);
+
+        USLOSS_Console("disk %d: ops %d  sectors %d  seek distance %d  queue depth %d (max %d)\n",
+                       unit, stats.ops, stats.sectors, stats.seekDistance,
+                       stats.queueDepth, stats.maxQueueDepth);
+        USLOSS_Console("disk %d: merged %d requests in %d passes  dedup hits %d  mirror reads %d (%d tracks saved)\n",
+                       unit, stats.mergedRequests, stats.mergedPasses, stats.dedupHits,
+                       stats.mirrorReads, stats.mirrorSeekSaved);
+        USLOSS_Console("disk %d: cache hits %d  read-ahead tracks %d  evictions %d  warm tracks %d (%d hits)\n",
+                       unit, stats.cacheHits, stats.readAheads, stats.cacheEvictions,
+                       stats.warmTracks, stats.warmHits);
+
+        USLOSS_Console("disk %d: wait    ", unit);
+        for (int i = 0; i < DISK_HIST_BUCKETS; i++)
+        {
+            USLOSS_Console(" %5d", stats.waitHist[i]);
+        }
+        USLOSS_Console("\ndisk %d: service ", unit);
+        for (int i = 0; i < DISK_HIST_BUCKETS; i++)
+        {
+            USLOSS_Console(" %5d", stats.serviceHist[i]);
+        }
+        USLOSS_Console("\n");
+    }
+}
+
+/*
+ * System call handler for the disk read operation
+ *
+ * Parameters:
+ *   sysargs - pointer to the USLOSS_Sysargs structure containing the system call arguments
+ *
+ * Returns:
+ *   void
+ */
+void diskReadHandler(USLOSS_Sysargs *sysargs)
+{
+    void *buffer = sysargs->arg1;
+    int sectors = (int)(long)sysargs->arg2;
+    int track = (int)(long)sysargs->arg3;
+    int first = (int)(long)sysargs->arg4;
+    int unit = (int)(long)sysargs->arg5;
+    int status = 0;
+
+    int res = kernDiskRead(buffer, unit, track, first, sectors, &status);
+
+    sysargs->arg1 = (void *)(long)status;
+    sysargs->arg4 = (void *)(long)res;
+}
+
+/*
+ * System call handler for the disk write operation
+ *
+ * Parameters:
+ *   sysargs - pointer to the USLOSS_Sysargs structure containing the system call arguments
+ *
+ * Returns:
+ *   void
+ */
+void diskWriteHandler(USLOSS_Sysargs *sysargs)
+{
+    void *buffer = sysargs->arg1;
+    int sectors = (int)(long)sysargs->arg2;
+    int track = (int)(long)sysargs->arg3;
+    int first = (int)(long)sysargs->arg4;
+    int unit = (int)(long)sysargs->arg5;
+    int status = 0;
+
+    int res = kernDiskWrite(buffer, unit, track, first, sectors, &status);
+
+    sysargs->arg1 = (void *)(long)status;
+    sysargs->arg4 = (void *)(long)res;
+}
+
+/*
+ * System call handler for the disk size operation
+ *
+ * Parameters:
+ *   sysargs - pointer to the USLOSS_Sysargs structure containing the system call arguments
+ *
+ * Returns:
+ *   void
+ */
+void diskSizeHandler(USLOSS_Sysargs *sysargs)
+{
+    int unit = (int)(long)sysargs->arg1;
+    int sector = 0;
+    int track = 0;
+    int disk = 0;
+
+    int res = kernDiskSize(unit, &sector, &track, &disk);
+
+    sysargs->arg1 = (void *)(long)sector;
+    sysargs->arg2 = (void *)(long)track;
+    sysargs->arg3 = (void *)(long)disk;
+    sysargs->arg4 = (void *)(long)res;
+}
+
+/*
+ * System call handler for the asynchronous disk read operation
+ *
+ * Parameters:
+ *   sysargs - pointer to the USLOSS_Sysargs structure containing the system call arguments
+ *
+ * Returns:
+ *   void
+ */
+void diskReadAsyncHandler(USLOSS_Sysargs *sysargs)
+{
+    void *buffer = sysargs->arg1;
+    int sectors = (int)(long)sysargs->arg2;
+    int track = (int)(long)sysargs->arg3;
+    int first = (int)(long)sysargs->arg4;
+    int unit = (int)(long)sysargs->arg5;
+    int handle = -1;
+
+    int res = kernDiskReadAsync(buffer, unit, track, first, sectors, &handle);
+
+    sysargs->arg1 = (void *)(long)handle;
+    sysargs->arg4 = (void *)(long)res;
+}
+
+/*
+ * System call handler for the asynchronous disk write operation
+ *
+ * Parameters:
+ *   sysargs - pointer to the USLOSS_Sysargs structure containing the system call arguments
+ *
+ * Returns:
+ *   void
+ */
+void diskWriteAsyncHandler(USLOSS_Sysargs *sysargs)
+{
+    void *buffer = sysargs->arg1;
+    int sectors = (int)(long)sysargs->arg2;
+    int track = (int)(long)sysargs->arg3;
+    int first = (int)(long)sysargs->arg4;
+    int unit = (int)(long)sysargs->arg5;
+    int handle = -1;
+
+    int res = kernDiskWriteAsync(buffer, unit, track, first, sectors, &handle);
+
+    sysargs->arg1 = (void *)(long)handle;
+    sysargs->arg4 = (void *)(long)res;
+}
+
+/*
+ * System call handler for waiting on an asynchronous disk operation
+ *
+ * Parameters:
+ *   sysargs - pointer to the USLOSS_Sysargs structure containing the system call arguments
+ *
+ * Returns:
+ *   void
+ */
+void diskWaitHandler(USLOSS_Sysargs *sysargs)
+{
+    int handle = (int)(long)sysargs->arg1;
+    int status = 0;
+
+    int res = kernDiskWait(&handle, &status);
+
+    sysargs->arg1 = (void *)(long)status;
+    sysargs->arg2 = (void *)(long)handle;
+    sysargs->arg4 = (void *)(long)res;
+}
+
+/*
+ * System call handler for the vectored disk read operation
+ *
+ * Parameters:
+ *   sysargs - pointer to the USLOSS_Sysargs structure containing the system call arguments
+ *
+ * Returns:
+ *   void
+ */
+void diskReadvHandler(USLOSS_Sysargs *sysargs)
+{
+    DiskIovec *iov = (DiskIovec *)sysargs->arg1;
+    int iovCount = (int)(long)sysargs->arg2;
+    int track = (int)(long)sysargs->arg3;
+    int first = (int)(long)sysargs->arg4;
+    int unit = (int)(long)sysargs->arg5;
+    int status = 0;
+
+    int res = kernDiskReadv(iov, iovCount, unit, track, first, &status);
+
+    sysargs->arg1 = (void *)(long)status;
+    sysargs->arg4 = (void *)(long)res;
+}
+
+/*
+ * System call handler for the vectored disk write operation
+ *
+ * Parameters:
+ *   sysargs - pointer to the USLOSS_Sysargs structure containing the system call arguments
+ *
+ * Returns:
+ *   void
+ */
+void diskWritevHandler(USLOSS_Sysargs *sysargs)
+{
+    DiskIovec *iov = (DiskIovec *)sysargs->arg1;
+    int iovCount = (int)(long)sysargs->arg2;
+    int track = (int)(long)sysargs->arg3;
+    int first = (int)(long)sysargs->arg4;
+    int unit = (int)(long)sysargs->arg5;
+    int status = 0;
+
+    int res = kernDiskWritev(iov, iovCount, unit, track, first, &status);
+
+    sysargs->arg1 = (void *)(long)status;
+    sysargs->arg4 = (void *)(long)res;
+}
+
+/*
+ * System call handler for the logical block read operation
+ *
+ * Parameters:
+ *   sysargs - pointer to the USLOSS_Sysargs structure containing the system call arguments
+ *
+ * Returns:
+ *   void
+ */
+void diskReadBlocksHandler(USLOSS_Sysargs *sysargs)
+{
+    void *buffer = sysargs->arg1;
+    int count = (int)(long)sysargs->arg2;
+    int lba = (int)(long)sysargs->arg3;
+    int unit = (int)(long)sysargs->arg5;
+    int status = 0;
+
+    int res = kernDiskReadBlocks(buffer, unit, lba, count, &status);
+
+    sysargs->arg1 = (void *)(long)status;
+    sysargs->arg4 = (void *)(long)res;
+}
+
+/*
+ * System call handler for the logical block write operation
+ *
+ * Parameters:
+ *   sysargs - pointer to the USLOSS_Sysargs structure containing the system call arguments
+ *
+ * Returns:
+ *   void
+ */
+void diskWriteBlocksHandler(USLOSS_Sysargs *sysargs)
+{
+    void *buffer = sysargs->arg1;
+    int count = (int)(long)sysargs->arg2;
+    int lba = (int)(long)sysargs->arg3;
+    int unit = (int)(long)sysargs->arg5;
+    int status = 0;
+
+    int res = kernDiskWriteBlocks(buffer, unit, lba, count, &status);
+
+    sysargs->arg1 = (void *)(long)status;
+    sysargs->arg4 = (void *)(long)res;
+}
+
+/*
+ * System call handler for reading a unit's fitted cost model
+ *
+ * Parameters:
+ *   sysargs - pointer to the USLOSS_Sysargs structure containing the system call arguments
+ *
+ * Returns:
+ *   void
+ */
+void diskGetModelHandler(USLOSS_Sysargs *sysargs)
+{
+    int unit = (int)(long)sysargs->arg1;
+    DiskCostModel *model = (DiskCostModel *)sysargs->arg2;
+
+    int res = kernDiskGetModel(unit, model);
+
+    sysargs->arg4 = (void *)(long)res;
+}
+
+/*
+ * System call handler for reading a unit's disk counters
+ *
+ * Parameters:
+ *   sysargs - pointer to the USLOSS_Sysargs structure containing the system call arguments
+ *
+ * Returns:
+ *   void
+ */
+void diskStatsHandler(USLOSS_Sysargs *sysargs)
+{
+    int unit = (int)(long)sysargs->arg1;
+    DiskUnitStats *stats = (DiskUnitStats *)sysargs->arg2;
+
+    int res = kernDiskStats(unit, stats);
+
+    sysargs->arg4 = (void *)(long)res;
+}
+
+/*
+ * System call handler for the disk copy operation
+ *
+ * Parameters:
+ *   sysargs - pointer to the USLOSS_Sysargs structure containing the system call arguments
+ *
+ * Returns:
+ *   void
+ */
+void diskCopyHandler(USLOSS_Sysargs *sysargs)
+{
+    int srcUnit = (int)(long)sysargs->arg1;
+    int srcLBA = (int)(long)sysargs->arg2;
+    int dstUnit = (int)(long)sysargs->arg3;
+    int dstLBA = (int)(long)sysargs->arg4;
+    int count = (int)(long)sysargs->arg5;
+    int status = 0;
+
+    int res = kernDiskCopy(srcUnit, srcLBA, dstUnit, dstLBA, count, &status);
+
+    sysargs->arg1 = (void *)(long)status;
+    sysargs->arg4 = (void *)(long)res;
+}
+
+/*
+ * System call handler for the disk zero operation
+ *
+ * Parameters:
+ *   sysargs - pointer to the USLOSS_Sysargs structure containing the system call arguments
+ *
+ * Returns:
+ *   void
+ */
+void diskZeroHandler(USLOSS_Sysargs *sysargs)
+{
+    int sectors = (int)(long)sysargs->arg2;
+    int track = (int)(long)sysargs->arg3;
+    int first = (int)(long)sysargs->arg4;
+    int unit = (int)(long)sysargs->arg5;
+    int status = 0;
+
+    int res = kernDiskZero(unit, track, first, sectors, &status);
+
+    sysargs->arg1 = (void *)(long)status;
+    sysargs->arg4 = (void *)(long)res;
+}
+
+/*
+ * System call handler for the disk advise operation
+ *
+ * Parameters:
+ *   sysargs - pointer to the USLOSS_Sysargs structure containing the system call arguments
+ *
+ * Returns:
+ *   void
+ */
+void diskAdviseHandler(USLOSS_Sysargs *sysargs)
+{
+    int unit = (int)(long)sysargs->arg1;
+    int track = (int)(long)sysargs->arg2;
+    int tracks = (int)(long)sysargs->arg3;
+    int hint = (int)(long)sysargs->arg4;
+
+    int res = kernDiskAdvise(unit, track, tracks, hint);
+
+    sysargs->arg4 = (void *)(long)res;
+}
+
+/*
+ * System call handler for setting a process's disk share and rate cap
+ *
+ * Parameters:
+ *   sysargs - pointer to the USLOSS_Sysargs structure containing the system call arguments
+ *
+ * Returns:
+ *   void
+ */
+void diskSetShareHandler(USLOSS_Sysargs *sysargs)
+{
+    int pid = (int)(long)sysargs->arg1;
+    int share = (int)(long)sysargs->arg2;
+    int rateCap = (int)(long)sysargs->arg3;
+
+    int res = kernDiskSetShare(pid, share, rateCap);
+
+    sysargs->arg4 = (void *)(long)res;
+}
+
+/*
+ * System call handler for reading a process's disk totals
+ *
+ * Parameters:
+ *   sysargs - pointer to the USLOSS_Sysargs structure containing the system call arguments
+ *
+ * Returns:
+ *   void
+ */
+void diskProcStatsHandler(USLOSS_Sysargs *sysargs)
+{
+    int pid = (int)(long)sysargs->arg1;
+    DiskProcCounters *counters = (DiskProcCounters *)sysargs->arg2;
+
+    int res = kernDiskProcStats(pid, counters);
+
+    sysargs->arg4 = (void *)(long)res;
+}
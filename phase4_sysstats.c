@@ -0,0 +1,222 @@
+/*
+ * phase4_sysstats.c
+ *
+ * This file contains the optional per-system-call accounting for Phase 4 of the
+ * CS 452 project.
+ *
+ * Built with PHASE4_SYSCALL_STATS set, every phase 4 system call handler is
+ * replaced in systemCallVec by a wrapper that calls the original and records,
+ * for that call number, how many calls were made, how many of them failed (left
+ * -1 in arg4, as every phase 4 handler does for invalid arguments), and how long
+ * each spent in the kernel, as a total, a maximum and a power-of-two histogram.
+ * The wrappers are installed last in phase4_init, so they cover the disk and
+ * batched submission handlers as well.
+ *
+ * Built without it, nothing is wrapped and the handlers run exactly as installed;
+ * SyscallStats then only reports that accounting is off.
+ *
+ * Author: Ishika Patel & Hamad Marhoon
+ */
+
+#include <stdio.h>
+#include <phase1.h>
+#include <phase2.h>
+#include <phase3.h>
+#include <phase4.h>
+#include <string.h>
+#include <stdlib.h>
+
+#ifndef PHASE4_SYSCALL_STATS
+#define PHASE4_SYSCALL_STATS 0
+#endif
+
+void syscallStatsHandler(USLOSS_Sysargs *sysargs);
+
+#if PHASE4_SYSCALL_STATS
+
+// every system call phase 4 installs, in the order SyscallStats reports them
+static const int syscallStatsNumbers[] = {
+    SYS_SLEEP, SYS_TERMREAD, SYS_TERMWRITE, SYS_DISKSIZE, SYS_DISKREAD, SYS_DISKWRITE,
+    SYS_DISKREADASYNC, SYS_DISKWRITEASYNC, SYS_DISKWAIT, SYS_DISKREADV, SYS_DISKWRITEV,
+    SYS_DISKREADBLOCKS, SYS_DISKWRITEBLOCKS, SYS_DISKGETMODEL, SYS_DISKSTATS,
+    SYS_DISKCOPY, SYS_DISKZERO, SYS_DISKADVISE, SYS_DISKSETSHARE, SYS_DISKPROCSTATS,
+    SYS_PHASE4SUBMIT, SYS_LOCKSTATS, SYS_SYSCALLSTATS, SYS_TRACEDUMP,
+    SYS_PHASE4STATS,
+};
+
+#define SYSCALL_STATS_COUNT ((int)(sizeof(syscallStatsNumbers) / sizeof(syscallStatsNumbers[0])))
+
+void (*syscallOriginal[MAXSYSCALLS])(USLOSS_Sysargs *); // the handler each wrapper calls
+SyscallStatsEntry syscallStats[MAXSYSCALLS];          // accounting by call number
+
+/*
+ * Returns the histogram bucket for a time in the kernel
+ *
+ * Parameters:
+ *   elapsed - the time in microseconds
+ *
+ * Returns:
+ *   int - the bucket, SYSCALL_HIST_BUCKETS - 1 for anything past the last bound
+ */
+static int syscallHistBucket(int elapsed)
+{
+    int bucket = 0;
+    while (bucket < SYSCALL_HIST_BUCKETS - 1 && elapsed >= (2 << bucket))
+    {
+        bucket++;
+    }
+    return bucket;
+}
+
+/*
+ * Calls the handler installed for a system call and records the call
+ *
+ * Parameters:
+ *   sysargs - pointer to the USLOSS_Sysargs structure containing the system call arguments
+ *
+ * Returns:
+ *   void
+ */
+static void syscallStatsWrapper(USLOSS_Sysargs *sysargs)
+{
+    int number = sysargs->number;
+    int started = currentTime();
+
+    syscallOriginal[number](sysargs);
+
+    int elapsed = currentTime() - started;
+    int failed = (long)sysargs->arg4 == -1;
+
+    // the handler may have blocked, so another call's update may be under way
+    unsigned int psr = USLOSS_PsrGet();
+    USLOSS_PsrSet(psr & ~USLOSS_PSR_CURRENT_INT);
+
+    SyscallStatsEntry *s = &syscallStats[number];
+    s->calls++;
+    s->errors += failed;
+    s->timeTotal += elapsed;
+    if (elapsed > s->timeMax)
+    {
+        s->timeMax = elapsed;
+    }
+    s->hist[syscallHistBucket(elapsed)]++;
+
+    USLOSS_PsrSet(psr);
+}
+
+#endif
+
+/*
+ * Installs the system call accounting call and, when accounting is built in,
+ * wraps every phase 4 handler installed so far
+ *
+ * Returns: void
+ */
+void phase4_sysstats_init(void)
+{
+    systemCallVec[SYS_SYSCALLSTATS] = syscallStatsHandler;
+
+#if PHASE4_SYSCALL_STATS
+    memset(syscallStats, 0, sizeof(syscallStats));
+    for (int i = 0; i < SYSCALL_STATS_COUNT; i++)
+    {
+        int number = syscallStatsNumbers[i];
+        syscallStats[number].number = number;
+        syscallOriginal[number] = systemCallVec[number];
+        systemCallVec[number] = syscallStatsWrapper;
+    }
+#endif
+}
+
+/*
+ * Copies out the accounting of every phase 4 system call
+ *
+ * Parameters:
+ *   entries - receives up to max entries, one per call number
+ *   max - the number of entries the caller has room for
+ *   count - receives the number of entries copied
+ *
+ * Returns:
+ *   int - returns 0 on success, -1 if invalid parameters are provided or
+ *         accounting was not built in
+ */
+int kernSyscallStats(SyscallStatsEntry *entries, int max, int *count)
+{
+    if (entries == NULL || max < 0)
+    {
+        return -1;
+    }
+
+#if PHASE4_SYSCALL_STATS
+    unsigned int psr = USLOSS_PsrGet();
+    USLOSS_PsrSet(psr & ~USLOSS_PSR_CURRENT_INT);
+
+    int n = SYSCALL_STATS_COUNT < max ? SYSCALL_STATS_COUNT : max;
+    for (int i = 0; i < n; i++)
+    {
+        entries[i] = syscallStats[syscallStatsNumbers[i]];
+    }
+
+    USLOSS_PsrSet(psr);
+
+    *count = n;
+    return 0;
+#else
+    *count = 0;
+    return -1;
+#endif
+}
+
+/*
+ * Prints the accounting of every phase 4 system call that has been made to the
+ * console
+ *
+ * Returns: void
+ */
+void dumpSyscallStats(void)
+{
+    SyscallStatsEntry entries[MAXSYSCALLS];
+    int count;
+
+    if (kernSyscallStats(entries, MAXSYSCALLS, &count) == -1)
+    {
+        USLOSS_Console("syscall stats not built in\n");
+        return;
+    }
+
+    USLOSS_Console("%7s %8s %8s %12s %8s\n", "syscall", "calls", "errors", "kernel us", "max");
+    for (int i = 0; i < count; i++)
+    {
+        SyscallStatsEntry *e = &entries[i];
+        if (e->calls == 0)
+        {
+            continue;
+        }
+        USLOSS_Console("%7d %8d %8d %12lld %8d\n", e->number, e->calls, e->errors,
+                       e->timeTotal, e->timeMax);
+    }
+}
+
+/*
+ * System call handler for getting the accounting of the phase 4 system calls
+ * It extracts the necessary arguments from the USLOSS_Sysargs structure
+ * and calls the kernSyscallStats function with the provided arguments
+ * The result of the kernSyscallStats function is stored back in the USLOSS_Sysargs structure
+ *
+ * Parameters:
+ *   sysargs - pointer to the USLOSS_Sysargs structure containing the system call arguments
+ *
+ * Returns:
+ *   void
+ */
+void syscallStatsHandler(USLOSS_Sysargs *sysargs)
+{
+    SyscallStatsEntry *entries = (SyscallStatsEntry *)sysargs->arg1;
+    int max = (int)(long)sysargs->arg2;
+    int count = 0;
+
+    int result = kernSyscallStats(entries, max, &count);
+
+    sysargs->arg1 = (void *)(long)count;
+    sysargs->arg4 = (void *)(long)result;
+}
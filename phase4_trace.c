@@ -0,0 +1,135 @@
+/*
+ * phase4_trace.c
+ *
+ * This file contains the kernel trace ring for Phase 4 of the CS 452 project.
+ *
+ * The drivers and system calls mark their hot paths with TRACE (see
+ * phase4_trace.h).  Built with PHASE4_TRACE set to a mask of event classes,
+ * each marked point in those classes writes a small fixed-size record with a
+ * timestamp into a ring of TRACE_RING_SIZE records, overwriting the oldest, and
+ * nothing is printed until the ring is dumped.  That keeps the timing of what is
+ * being traced close to an untraced run, which printing with USLOSS_Console from
+ * the same places does not.
+ *
+ * The ring is dumped by dumpTrace from kernel code or by TraceDump from a user
+ * process.  Built with PHASE4_TRACE_AT_HALT as well, it is also dumped when
+ * USLOSS halts.
+ *
+ * Author: Ishika Patel & Hamad Marhoon
+ */
+
+#include <stdio.h>
+#include <phase1.h>
+#include <phase2.h>
+#include <phase3.h>
+#include <phase4.h>
+#include <phase4_trace.h>
+#include <string.h>
+#include <stdlib.h>
+
+#ifndef PHASE4_TRACE_AT_HALT
+#define PHASE4_TRACE_AT_HALT 0
+#endif
+
+void traceDumpHandler(USLOSS_Sysargs *sysargs);
+
+#if PHASE4_TRACE
+
+TraceRecord traceRing[TRACE_RING_SIZE];
+unsigned int traceNext = 0; // records written so far; the next goes in traceNext % TRACE_RING_SIZE
+
+static char *traceEventNames[] = {
+    "?", "interrupt", "line", "line-drop", "xmit", "sleep", "wake", "disk-start", "disk-end",
+};
+
+#endif
+
+/*
+ * Installs the trace dump system call and, when asked to, has the ring dumped
+ * when USLOSS halts
+ *
+ * Returns: void
+ */
+void phase4_trace_init(void)
+{
+    systemCallVec[SYS_TRACEDUMP] = traceDumpHandler;
+
+#if PHASE4_TRACE && PHASE4_TRACE_AT_HALT
+    // USLOSS_Halt leaves through exit()
+    atexit(dumpTrace);
+#endif
+}
+
+/*
+ * Writes one record into the trace ring
+ * Called through TRACE, so it is only reached for the classes built in
+ *
+ * Parameters:
+ *   event - the TRACE_ event
+ *   a, b, c - the event's arguments, as listed in phase4_trace.h
+ *
+ * Returns: void
+ */
+void traceRecord(int event, int a, int b, int c)
+{
+#if PHASE4_TRACE
+    unsigned int psr = USLOSS_PsrGet();
+    USLOSS_PsrSet(psr & ~USLOSS_PSR_CURRENT_INT);
+
+    TraceRecord *r = &traceRing[traceNext++ % TRACE_RING_SIZE];
+    r->time = currentTime();
+    r->event = event;
+    r->pid = getpid();
+    r->a = a;
+    r->b = b;
+    r->c = c;
+
+    USLOSS_PsrSet(psr);
+#endif
+}
+
+/*
+ * Prints the records in the trace ring to the console, oldest first
+ *
+ * Returns: void
+ */
+void dumpTrace(void)
+{
+#if PHASE4_TRACE
+    unsigned int psr = USLOSS_PsrGet();
+    USLOSS_PsrSet(psr & ~USLOSS_PSR_CURRENT_INT);
+
+    unsigned int end = traceNext;
+    unsigned int start = end > TRACE_RING_SIZE ? end - TRACE_RING_SIZE : 0;
+
+    USLOSS_Console("trace: %u records, %u overwritten\n", end, start);
+    USLOSS_Console("%10s %5s %-10s %8s %8s %8s\n", "time", "pid", "event", "a", "b", "c");
+    for (unsigned int i = start; i < end; i++)
+    {
+        TraceRecord *r = &traceRing[i % TRACE_RING_SIZE];
+        int named = r->event > 0 && r->event <= TRACE_DISK_END;
+        USLOSS_Console("%10d %5d %-10s %8d %8d %8d\n", r->time, r->pid,
+                       traceEventNames[named ? r->event : 0], r->a, r->b, r->c);
+    }
+
+    USLOSS_PsrSet(psr);
+#else
+    USLOSS_Console("trace not built in\n");
+#endif
+}
+
+/*
+ * System call handler for dumping the trace ring
+ * The result is stored back in the USLOSS_Sysargs structure
+ *
+ * Parameters:
+ *   sysargs - pointer to the USLOSS_Sysargs structure containing the system call arguments
+ *
+ * Returns:
+ *   void
+ */
+void traceDumpHandler(USLOSS_Sysargs *sysargs)
+{
+    dumpTrace();
+    sysargs->arg4 = (void *)(long)(PHASE4_TRACE ? 0 : -1);
+}
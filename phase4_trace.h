@@ -0,0 +1,60 @@
+/*
+ * These are the definitions for the phase 4 kernel trace ring.
+ */
+
+#ifndef _PHASE4_TRACE_H
+#define _PHASE4_TRACE_H
+
+/*
+ * event classes; PHASE4_TRACE is the set of classes recorded, and every
+ * TRACE of a class outside it compiles to nothing, so the default of 0
+ * costs nothing at all
+ */
+#define TRACE_CLASS_INTERRUPT  0x01  // device interrupts received by the drivers
+#define TRACE_CLASS_TERM       0x02  // lines delivered or dropped, characters transmitted
+#define TRACE_CLASS_SLEEP      0x04  // sleepers enqueued and woken
+#define TRACE_CLASS_DISK       0x08  // device operations started and finished
+#define TRACE_CLASS_ALL        0x0f
+
+#ifndef PHASE4_TRACE
+#define PHASE4_TRACE 0
+#endif
+
+#ifndef TRACE_RING_SIZE
+#define TRACE_RING_SIZE 1024 // records kept; the oldest are overwritten
+#endif
+
+/*
+ * events, and what their three arguments hold
+ */
+#define TRACE_INTERRUPT       1  // device, unit, status
+#define TRACE_LINE_DELIVERED  2  // terminal unit, line length, lines now buffered
+#define TRACE_LINE_DROPPED    3  // terminal unit, line length, lines now buffered
+#define TRACE_CHAR_XMIT       4  // terminal unit, character, characters written so far
+#define TRACE_SLEEP_ENQUEUE   5  // pid, wakeup tick, current tick
+#define TRACE_SLEEP_WAKE      6  // pid, wakeup tick, current tick
+#define TRACE_DISK_START      7  // disk unit, USLOSS operation, first argument
+#define TRACE_DISK_END        8  // disk unit, USLOSS operation, device status
+
+typedef struct TraceRecord
+{
+    int time;    // currentTime() when it was recorded
+    short event;
+    short pid;   // the process that recorded it
+    int a;
+    int b;
+    int c;
+} TraceRecord;
+
+extern void traceRecord(int event, int a, int b, int c);
+
+#define TRACE(cls, event, a, b, c)                 \
+    do                                             \
+    {                                              \
+        if (PHASE4_TRACE & (cls))                  \
+        {                                          \
+            traceRecord((event), (a), (b), (c));   \
+        }                                          \
+    } while (0)
+
+#endif /* _PHASE4_TRACE_H */
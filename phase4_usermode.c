@@ -8,6 +8,7 @@
 #include <usloss.h>
 #include <usyscall.h>
 
+#include "phase4.h"
 #include "phase4_usermode.h"
 
 #define CHECKMODE { \
@@ -201,4 +202,620 @@ int DiskSize(int unit, int *sector, int *track, int *disk)
     return (long) sysArg.arg4;
 } /* end of DiskSize */
 
+
+/*
+ *  Routine:  DiskStats
+ *
+ *  Description: This is the call entry point for getting the disk
+ *               driver's counters for a unit.
+ *
+ *  Arguments:    int  unit            -- which disk
+ *                DiskUnitStats *stats -- pointer to output value
+ *                (output value: operation, seek, queue and latency counters)
+ *
+ *  Return Value: 0 means success, -1 means error occurs
+ */
+int DiskStats(int unit, DiskUnitStats *stats)
+{
+    USLOSS_Sysargs sysArg;
+
+    CHECKMODE;
+    sysArg.number = SYS_DISKSTATS;
+    sysArg.arg1 = (void *) ( (long) unit);
+    sysArg.arg2 = (void *) stats;
+
+    USLOSS_Syscall(&sysArg);
+
+    return (long) sysArg.arg4;
+} /* end of DiskStats */
+
+
+/*
+ *  Routine:  DiskReadAsync
+ *
+ *  Description: This is the call entry point for queueing disk input
+ *               without waiting for it to finish.
+ *
+ *  Arguments:    void* diskBuffer  -- pointer to the input buffer; must stay
+ *                                     valid until the read is waited for
+ *                int   unit -- which disk to read
+ *                int   track  -- first track to read
+ *                int   first -- first sector to read
+ *                int   sectors -- number of sectors to read
+ *                int   *handle    -- pointer to output value
+ *                (output value: handle to pass to DiskWait)
+ *
+ *  Return Value: 0 means success, -1 means error occurs
+ */
+int DiskReadAsync(void *diskBuffer, int unit, int track, int first, int sectors,
+    int *handle)
+{
+    USLOSS_Sysargs sysArg;
+
+    CHECKMODE;
+    sysArg.number = SYS_DISKREADASYNC;
+    sysArg.arg1 = diskBuffer;
+    sysArg.arg2 = (void *) ( (long) sectors);
+    sysArg.arg3 = (void *) ( (long) track);
+    sysArg.arg4 = (void *) ( (long) first);
+    sysArg.arg5 = (void *) ( (long) unit);
+
+    USLOSS_Syscall(&sysArg);
+
+    *handle = (long) sysArg.arg1;
+    return (long) sysArg.arg4;
+} /* end of DiskReadAsync */
+
+
+/*
+ *  Routine:  DiskWriteAsync
+ *
+ *  Description: This is the call entry point for queueing disk output
+ *               without waiting for it to finish.
+ *
+ *  Arguments:    void *diskBuffer -- pointer to the output buffer; must stay
+ *                                    valid until the write is waited for
+ *                int   unit       -- which disk to write
+ *                int   track      -- first track to write
+ *                int   first      -- first sector to write
+ *                int   sectors    -- number of sectors to write
+ *                int  *handle     -- pointer to output value
+ *                (output value: handle to pass to DiskWait)
+ *
+ *  Return Value: 0 means success, -1 means error occurs
+ */
+int DiskWriteAsync(void *diskBuffer, int unit, int track, int first, int sectors,
+                   int *handle)
+{
+    USLOSS_Sysargs sysArg;
+
+    CHECKMODE;
+    sysArg.number = SYS_DISKWRITEASYNC;
+    sysArg.arg1 = diskBuffer;
+    sysArg.arg2 = (void *) ( (long) sectors);
+    sysArg.arg3 = (void *) ( (long) track);
+    sysArg.arg4 = (void *) ( (long) first);
+    sysArg.arg5 = (void *) ( (long) unit);
+
+    USLOSS_Syscall(&sysArg);
+
+    *handle = (long) sysArg.arg1;
+    return (long) sysArg.arg4;
+} /* end of DiskWriteAsync */
+
+
+/*
+ *  Routine:  DiskWait
+ *
+ *  Description: This is the call entry point for waiting on a queued
+ *               disk operation.
+ *
+ *  Arguments:    int   handle  -- handle from DiskReadAsync/DiskWriteAsync
+ *                int  *status  -- pointer to output value
+ *                (output value: completion status)
+ *
+ *  Return Value: 0 means success, -1 means error occurs
+ */
+int DiskWait(int handle, int *status)
+{
+    USLOSS_Sysargs sysArg;
+
+    CHECKMODE;
+    sysArg.number = SYS_DISKWAIT;
+    sysArg.arg1 = (void *) ( (long) handle);
+
+    USLOSS_Syscall(&sysArg);
+
+    *status = (long) sysArg.arg1;
+    return (long) sysArg.arg4;
+} /* end of DiskWait */
+
+
+/*
+ *  Routine:  DiskWaitAny
+ *
+ *  Description: This is the call entry point for waiting on whichever
+ *               queued disk operation finishes first.
+ *
+ *  Arguments:    int  *handle  -- pointer to output value
+ *                (output value: handle of the operation that finished)
+ *                int  *status  -- pointer to output value
+ *                (output value: completion status)
+ *
+ *  Return Value: 0 means success, -1 means error occurs
+ *                (-1 also means nothing was outstanding)
+ */
+int DiskWaitAny(int *handle, int *status)
+{
+    USLOSS_Sysargs sysArg;
+
+    CHECKMODE;
+    sysArg.number = SYS_DISKWAIT;
+    sysArg.arg1 = (void *) ( (long) -1);
+
+    USLOSS_Syscall(&sysArg);
+
+    *status = (long) sysArg.arg1;
+    *handle = (long) sysArg.arg2;
+    return (long) sysArg.arg4;
+} /* end of DiskWaitAny */
+
+
+/*
+ *  Routine:  DiskReadv
+ *
+ *  Description: This is the call entry point for disk input into several
+ *               separate buffers.
+ *
+ *  Arguments:    DiskIovec *iov -- fragments to fill, in sector order
+ *                int   iovCount -- number of fragments
+ *                int   unit     -- which disk to read
+ *                int   track    -- first track to read
+ *                int   first    -- first sector to read
+ *                int  *status   -- pointer to output value
+ *                (output value: completion status)
+ *
+ *  Return Value: 0 means success, -1 means error occurs
+ */
+int DiskReadv(DiskIovec *iov, int iovCount, int unit, int track, int first,
+              int *status)
+{
+    USLOSS_Sysargs sysArg;
+
+    CHECKMODE;
+    sysArg.number = SYS_DISKREADV;
+    sysArg.arg1 = (void *) iov;
+    sysArg.arg2 = (void *) ( (long) iovCount);
+    sysArg.arg3 = (void *) ( (long) track);
+    sysArg.arg4 = (void *) ( (long) first);
+    sysArg.arg5 = (void *) ( (long) unit);
+
+    USLOSS_Syscall(&sysArg);
+
+    *status = (long) sysArg.arg1;
+    return (long) sysArg.arg4;
+} /* end of DiskReadv */
+
+
+/*
+ *  Routine:  DiskWritev
+ *
+ *  Description: This is the call entry point for disk output from several
+ *               separate buffers.
+ *
+ *  Arguments:    DiskIovec *iov -- fragments to write, in sector order
+ *                int   iovCount -- number of fragments
+ *                int   unit     -- which disk to write
+ *                int   track    -- first track to write
+ *                int   first    -- first sector to write
+ *                int  *status   -- pointer to output value
+ *                (output value: completion status)
+ *
+ *  Return Value: 0 means success, -1 means error occurs
+ */
+int DiskWritev(DiskIovec *iov, int iovCount, int unit, int track, int first,
+               int *status)
+{
+    USLOSS_Sysargs sysArg;
+
+    CHECKMODE;
+    sysArg.number = SYS_DISKWRITEV;
+    sysArg.arg1 = (void *) iov;
+    sysArg.arg2 = (void *) ( (long) iovCount);
+    sysArg.arg3 = (void *) ( (long) track);
+    sysArg.arg4 = (void *) ( (long) first);
+    sysArg.arg5 = (void *) ( (long) unit);
+
+    USLOSS_Syscall(&sysArg);
+
+    *status = (long) sysArg.arg1;
+    return (long) sysArg.arg4;
+} /* end of DiskWritev */
+
+
+/*
+ *  Routine:  DiskReadBlocks
+ *
+ *  Description: This is the call entry point for disk input addressed by
+ *               logical sector, ignoring track boundaries.
+ *
+ *  Arguments:    void* diskBuffer  -- pointer to the input buffer
+ *                int   unit   -- which disk to read
+ *                int   lba    -- first logical sector to read
+ *                                (track * track size + sector)
+ *                int   count  -- number of sectors to read
+ *                int  *status -- pointer to output value
+ *                (output value: completion status)
+ *
+ *  Return Value: 0 means success, -1 means error occurs
+ */
+int DiskReadBlocks(void *diskBuffer, int unit, int lba, int count, int *status)
+{
+    USLOSS_Sysargs sysArg;
+
+    CHECKMODE;
+    sysArg.number = SYS_DISKREADBLOCKS;
+    sysArg.arg1 = diskBuffer;
+    sysArg.arg2 = (void *) ( (long) count);
+    sysArg.arg3 = (void *) ( (long) lba);
+    sysArg.arg5 = (void *) ( (long) unit);
+
+    USLOSS_Syscall(&sysArg);
+
+    *status = (long) sysArg.arg1;
+    return (long) sysArg.arg4;
+} /* end of DiskReadBlocks */
+
+
+/*
+ *  Routine:  DiskWriteBlocks
+ *
+ *  Description: This is the call entry point for disk output addressed by
+ *               logical sector, ignoring track boundaries.
+ *
+ *  Arguments:    void *diskBuffer -- pointer to the output buffer
+ *                int   unit   -- which disk to write
+ *                int   lba    -- first logical sector to write
+ *                                (track * track size + sector)
+ *                int   count  -- number of sectors to write
+ *                int  *status -- pointer to output value
+ *                (output value: completion status)
+ *
+ *  Return Value: 0 means success, -1 means error occurs
+ */
+int DiskWriteBlocks(void *diskBuffer, int unit, int lba, int count, int *status)
+{
+    USLOSS_Sysargs sysArg;
+
+    CHECKMODE;
+    sysArg.number = SYS_DISKWRITEBLOCKS;
+    sysArg.arg1 = diskBuffer;
+    sysArg.arg2 = (void *) ( (long) count);
+    sysArg.arg3 = (void *) ( (long) lba);
+    sysArg.arg5 = (void *) ( (long) unit);
+
+    USLOSS_Syscall(&sysArg);
+
+    *status = (long) sysArg.arg1;
+    return (long) sysArg.arg4;
+} /* end of DiskWriteBlocks */
+
+
+/*
+ *  Routine:  DiskGetModel
+ *
+ *  Description: This is the call entry point for reading the service-time
+ *               model the disk driver has fitted for a unit.
+ *
+ *  Arguments:    int  unit            -- which disk
+ *                DiskCostModel *model -- pointer to output value
+ *                (output value: seek and transfer costs, in microseconds)
+ *
+ *  Return Value: 0 means success, -1 means error occurs
+ */
+int DiskGetModel(int unit, DiskCostModel *model)
+{
+    USLOSS_Sysargs sysArg;
+
+    CHECKMODE;
+    sysArg.number = SYS_DISKGETMODEL;
+    sysArg.arg1 = (void *) ( (long) unit);
+    sysArg.arg2 = (void *) model;
+
+    USLOSS_Syscall(&sysArg);
+
+    return (long) sysArg.arg4;
+} /* end of DiskGetModel */
+
+
+/*
+ *  Routine:  DiskCopy
+ *
+ *  Description: This is the call entry point for copying sectors between
+ *               or within disks without passing them through user memory.
+ *
+ *  Arguments:    int  srcUnit -- which disk to copy from
+ *                int  srcLBA  -- first logical sector to copy
+ *                int  dstUnit -- which disk to copy to
+ *                int  dstLBA  -- first logical sector to write
+ *                int  count   -- number of sectors to copy
+ *                int *status  -- pointer to output value
+ *                (output value: completion status)
+ *
+ *  Return Value: 0 means success, -1 means error occurs
+ */
+int DiskCopy(int srcUnit, int srcLBA, int dstUnit, int dstLBA, int count,
+             int *status)
+{
+    USLOSS_Sysargs sysArg;
+
+    CHECKMODE;
+    sysArg.number = SYS_DISKCOPY;
+    sysArg.arg1 = (void *) ( (long) srcUnit);
+    sysArg.arg2 = (void *) ( (long) srcLBA);
+    sysArg.arg3 = (void *) ( (long) dstUnit);
+    sysArg.arg4 = (void *) ( (long) dstLBA);
+    sysArg.arg5 = (void *) ( (long) count);
+
+    USLOSS_Syscall(&sysArg);
+
+    *status = (long) sysArg.arg1;
+    return (long) sysArg.arg4;
+} /* end of DiskCopy */
+
+
+/*
+ *  Routine:  DiskZero
+ *
+ *  Description: This is the call entry point for writing zeros over a
+ *               range of sectors without supplying a buffer.
+ *
+ *  Arguments:    int  unit    -- which disk to zero
+ *                int  track   -- first track to zero
+ *                int  first   -- first sector on that track
+ *                int  sectors -- number of sectors to zero
+ *                int *status  -- pointer to output value
+ *                (output value: completion status)
+ *
+ *  Return Value: 0 means success, -1 means error occurs
+ */
+int DiskZero(int unit, int track, int first, int sectors, int *status)
+{
+    USLOSS_Sysargs sysArg;
+
+    CHECKMODE;
+    sysArg.number = SYS_DISKZERO;
+    sysArg.arg2 = (void *) ( (long) sectors);
+    sysArg.arg3 = (void *) ( (long) track);
+    sysArg.arg4 = (void *) ( (long) first);
+    sysArg.arg5 = (void *) ( (long) unit);
+
+    USLOSS_Syscall(&sysArg);
+
+    *status = (long) sysArg.arg1;
+    return (long) sysArg.arg4;
+} /* end of DiskZero */
+
+
+/*
+ *  Routine:  DiskAdvise
+ *
+ *  Description: This is the call entry point for telling the disk
+ *               subsystem how a range of tracks will be accessed.
+ *
+ *  Arguments:    int  unit   -- which disk
+ *                int  track  -- first track of the range
+ *                int  tracks -- number of tracks in the range
+ *                int  hint   -- one of the DISK_ADVICE_ values
+ *
+ *  Return Value: 0 means success, -1 means error occurs
+ */
+int DiskAdvise(int unit, int track, int tracks, int hint)
+{
+    USLOSS_Sysargs sysArg;
+
+    CHECKMODE;
+    sysArg.number = SYS_DISKADVISE;
+    sysArg.arg1 = (void *) ( (long) unit);
+    sysArg.arg2 = (void *) ( (long) track);
+    sysArg.arg3 = (void *) ( (long) tracks);
+    sysArg.arg4 = (void *) ( (long) hint);
+
+    USLOSS_Syscall(&sysArg);
+
+    return (long) sysArg.arg4;
+} /* end of DiskAdvise */
+
+
+/*
+ *  Routine:  DiskSetShare
+ *
+ *  Description: This is the call entry point for setting a process's
+ *               share of the disks and its transfer rate cap.
+ *
+ *  Arguments:    int  pid     -- which process, -1 for the caller
+ *                int  share   -- weight against other processes
+ *                int  rateCap -- sectors per second, 0 for no cap
+ *
+ *  Return Value: 0 means success, -1 means error occurs
+ */
+int DiskSetShare(int pid, int share, int rateCap)
+{
+    USLOSS_Sysargs sysArg;
+
+    CHECKMODE;
+    sysArg.number = SYS_DISKSETSHARE;
+    sysArg.arg1 = (void *) ( (long) pid);
+    sysArg.arg2 = (void *) ( (long) share);
+    sysArg.arg3 = (void *) ( (long) rateCap);
+
+    USLOSS_Syscall(&sysArg);
+
+    return (long) sysArg.arg4;
+} /* end of DiskSetShare */
+
+
+/*
+ *  Routine:  DiskProcStats
+ *
+ *  Description: This is the call entry point for getting a process's
+ *               disk share, rate cap and transfer totals.
+ *
+ *  Arguments:    int  pid                    -- which process, -1 for the caller
+ *                DiskProcCounters *counters  -- pointer to output value
+ *
+ *  Return Value: 0 means success, -1 means error occurs
+ */
+int DiskProcStats(int pid, DiskProcCounters *counters)
+{
+    USLOSS_Sysargs sysArg;
+
+    CHECKMODE;
+    sysArg.number = SYS_DISKPROCSTATS;
+    sysArg.arg1 = (void *) ( (long) pid);
+    sysArg.arg2 = (void *) counters;
+
+    USLOSS_Syscall(&sysArg);
+
+    return (long) sysArg.arg4;
+} /* end of DiskProcStats */
+
+
+/*
+ *  Routine:  Phase4Submit
+ *
+ *  Description: This is the call entry point for running a batch of
+ *               sleep, terminal and disk operations with one system call.
+ *
+ *  Arguments:    Phase4Op *ops                  -- the operations
+ *                int  count                     -- number of operations
+ *                Phase4Completion *completions  -- one entry per operation,
+ *                                                  in the order they finished
+ *                int *completed                 -- pointer to output value
+ *                (output value: number of completions filled in)
+ *
+ *  Return Value: 0 means success, -1 means error occurs
+ */
+int Phase4Submit(Phase4Op *ops, int count, Phase4Completion *completions,
+                 int *completed)
+{
+    USLOSS_Sysargs sysArg;
+
+    CHECKMODE;
+    sysArg.number = SYS_PHASE4SUBMIT;
+    sysArg.arg1 = (void *) ops;
+    sysArg.arg2 = (void *) ( (long) count);
+    sysArg.arg3 = (void *) completions;
+
+    USLOSS_Syscall(&sysArg);
+
+    *completed = (long) sysArg.arg1;
+    return (long) sysArg.arg4;
+} /* end of Phase4Submit */
+
+
+/*
+ *  Routine:  LockStats
+ *
+ *  Description: This is the call entry point for getting the contention
+ *               profile of every kernel lock in phase 4.
+ *
+ *  Arguments:    LockStatsEntry *entries -- array to fill in
+ *                int  max                -- number of entries in the array
+ *                int *count              -- pointer to output value
+ *                (output value: number of entries filled in)
+ *
+ *  Return Value: 0 means success, -1 means error occurs
+ */
+int LockStats(LockStatsEntry *entries, int max, int *count)
+{
+    USLOSS_Sysargs sysArg;
+
+    CHECKMODE;
+    sysArg.number = SYS_LOCKSTATS;
+    sysArg.arg1 = (void *) entries;
+    sysArg.arg2 = (void *) ( (long) max);
+
+    USLOSS_Syscall(&sysArg);
+
+    *count = (long) sysArg.arg1;
+    return (long) sysArg.arg4;
+} /* end of LockStats */
+
+/*
+ *  Routine:  SyscallStats
+ *
+ *  Description: This is the call entry point for getting the call counts,
+ *               error counts and kernel times of every phase 4 system call.
+ *               Only kernels built with PHASE4_SYSCALL_STATS keep them.
+ *
+ *  Arguments:    SyscallStatsEntry *entries -- array to fill in
+ *                int  max                   -- number of entries in the array
+ *                int *count                 -- pointer to output value
+ *                (output value: number of entries filled in)
+ *
+ *  Return Value: 0 means success, -1 means error occurs or the accounting
+ *                is not built in
+ */
+int SyscallStats(SyscallStatsEntry *entries, int max, int *count)
+{
+    USLOSS_Sysargs sysArg;
+
+    CHECKMODE;
+    sysArg.number = SYS_SYSCALLSTATS;
+    sysArg.arg1 = (void *) entries;
+    sysArg.arg2 = (void *) ( (long) max);
+
+    USLOSS_Syscall(&sysArg);
+
+    *count = (long) sysArg.arg1;
+    return (long) sysArg.arg4;
+} /* end of SyscallStats */
+
+/*
+ *  Routine:  TraceDump
+ *
+ *  Description: This is the call entry point for printing the kernel trace
+ *               ring to the console.  Only kernels built with PHASE4_TRACE
+ *               keep one.
+ *
+ *  Arguments:    none
+ *
+ *  Return Value: 0 means success, -1 means the trace is not built in
+ */
+int TraceDump(void)
+{
+    USLOSS_Sysargs sysArg;
+
+    CHECKMODE;
+    sysArg.number = SYS_TRACEDUMP;
+
+    USLOSS_Syscall(&sysArg);
+
+    return (long) sysArg.arg4;
+} /* end of TraceDump */
+
+/*
+ *  Routine:  GetPhase4Stats
+ *
+ *  Description: This is the call entry point for getting a snapshot of the
+ *               clock, terminal and disk counters of phase 4 in one call.
+ *
+ *  Arguments:    Phase4Stats *stats -- structure to fill in
+ *
+ *  Return Value: 0 means success, -1 means error occurs
+ */
+int GetPhase4Stats(Phase4Stats *stats)
+{
+    USLOSS_Sysargs sysArg;
+
+    CHECKMODE;
+    sysArg.number = SYS_PHASE4STATS;
+    sysArg.arg1 = (void *) stats;
+
+    USLOSS_Syscall(&sysArg);
+
+    return (long) sysArg.arg4;
+} /* end of GetPhase4Stats */
+
 /* end libuser.c */
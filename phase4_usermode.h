@@ -5,6 +5,8 @@
 #ifndef _PHASE4_USERMODE_H
 #define _PHASE4_USERMODE_H
 
+#include "phase4.h"
+
 /*
  * Function prototypes for this phase.
  */
@@ -16,6 +18,35 @@ extern  int  DiskRead (void *diskBuffer, int unit, int track, int first,
 extern  int  DiskWrite(void *diskBuffer, int unit, int track, int first,
                        int sectors, int *status);
 extern  int  DiskSize (int unit, int *sector, int *track, int *disk);
+extern  int  DiskStats(int unit, DiskUnitStats *stats);
+extern  int  DiskReadAsync (void *diskBuffer, int unit, int track, int first,
+                            int sectors, int *handle);
+extern  int  DiskWriteAsync(void *diskBuffer, int unit, int track, int first,
+                            int sectors, int *handle);
+extern  int  DiskWait      (int handle, int *status);
+extern  int  DiskWaitAny   (int *handle, int *status);
+extern  int  DiskReadv (DiskIovec *iov, int iovCount, int unit, int track,
+                        int first, int *status);
+extern  int  DiskWritev(DiskIovec *iov, int iovCount, int unit, int track,
+                        int first, int *status);
+extern  int  DiskReadBlocks (void *diskBuffer, int unit, int lba, int count,
+                             int *status);
+extern  int  DiskWriteBlocks(void *diskBuffer, int unit, int lba, int count,
+                             int *status);
+extern  int  DiskGetModel(int unit, DiskCostModel *model);
+extern  int  DiskCopy(int srcUnit, int srcLBA, int dstUnit, int dstLBA,
+                      int count, int *status);
+extern  int  DiskZero(int unit, int track, int first, int sectors,
+                      int *status);
+extern  int  DiskAdvise(int unit, int track, int tracks, int hint);
+extern  int  DiskSetShare(int pid, int share, int rateCap);
+extern  int  DiskProcStats(int pid, DiskProcCounters *counters);
+extern  int  Phase4Submit(Phase4Op *ops, int count,
+                          Phase4Completion *completions, int *completed);
+extern  int  LockStats(LockStatsEntry *entries, int max, int *count);
+extern  int  SyscallStats(SyscallStatsEntry *entries, int max, int *count);
+extern  int  TraceDump(void);
+extern  int  GetPhase4Stats(Phase4Stats *stats);
 extern  int  TermRead (char *buffer, int bufferSize, int unitID,
                        int *numCharsRead);
 extern  int  TermWrite(char *buffer, int bufferSize, int unitID,
@@ -8,12 +8,17 @@
  * The clock device driver implements the Sleep() system call, allowing processes
  * to sleep for a specified number of seconds. The terminal device driver handles
  * the reading and writing of characters to and from the terminal units. The disk
- * device driver provides functionality for reading and writing to the disk, as well
- * as querying the disk size.
+ * device driver, which lives in phase4_disk.c, provides functionality for reading
+ * and writing to the disk, as well as querying the disk size.
  *
  * The file also contains various helper functions and data structures used by the
- * device drivers and system calls. These include functions for locking and unlocking
- * mailboxes, as well as structures for managing sleeping processes.
+ * device drivers and system calls. These include a kernel mutex and a kernel event
+ * built on interrupt masking and blockMe/unblockProc, as well as structures for
+ * managing sleeping processes.
+ *
+ * Drivers are normally processes that loop on waitDevice. Built with
+ * DRIVERS_IN_INTERRUPT, the clock and terminal drivers instead run as state
+ * machines registered with registerInterruptDriver, in the interrupt itself.
  *
  * Author: Ishika Patel & Hamad Marhoon
  */
@@ -23,6 +28,7 @@
 #include <phase2.h>
 #include <phase3.h>
 #include <phase4.h>
+#include <phase4_trace.h>
 #include <string.h>
 #include <stdlib.h>
 #include <stdint.h>
@@ -35,85 +41,464 @@ typedef struct SleepProc
 } SleepProc;
 
 int clock_ticks = 0;        // amount of clock ticks that have occurred
-int sleep_lock;             // lock for sleep handler
+KernelMutex sleep_lock;     // lock for sleep handler
 int totalSleepingProcs = 0; // total number of sleeping procs in queue
 
 SleepProc sleepTable[MAXPROC]; // memory for processes created
 SleepProc *sleepQueue = NULL;  // queue for waking up sleeping procs
+KernelEvent sleepEvents[MAXPROC]; // signalled by the clock driver when a sleeper's time is up
+KernelEvent clockTickEvent;       // signalled for every waiter on each clock tick
+
+#define CLOCK_TICK_US 100000 // time between the clock ticks Sleep counts in
+
+#define TERM_LINE_SLOTS 10 // completed lines buffered per terminal unit
+
+typedef struct TermLines
+{
+    char lines[TERM_LINE_SLOTS][MAXLINE];
+    int lengths[TERM_LINE_SLOTS];
+    int head;  // oldest line
+    int count; // lines waiting to be read
+} TermLines;
+
+KernelMutex termWriteLocks[USLOSS_TERM_UNITS]; // write lock for each of 4 terminal devices
+KernelEvent termXmitEvents[USLOSS_TERM_UNITS]; // signalled when a unit is ready for the next character
+
+TermLines termLines[USLOSS_TERM_UNITS];       // 10 line buffers for each unit
+KernelEvent termLineEvents[USLOSS_TERM_UNITS]; // signalled when a line is added to a unit's buffers
+
+Phase4TermCounters termCounters[USLOSS_TERM_UNITS]; // reported by GetPhase4Stats; linesQueued is filled in then
+
+// GetPhase4Stats copies every unit, so the snapshot must have room for exactly that many
+_Static_assert(PHASE4_STATS_TERMS == USLOSS_TERM_UNITS, "PHASE4_STATS_TERMS must match USLOSS_TERM_UNITS");
+_Static_assert(PHASE4_STATS_DISKS == USLOSS_DISK_UNITS, "PHASE4_STATS_DISKS must match USLOSS_DISK_UNITS");
+
+typedef struct TermRxState
+{
+    char buff[MAXLINE]; // the line being received
+    int length;
+} TermRxState;
+
+/*
+ * Built with TERM_EVENT_LOOP set, one TerminalServiceDriver process serves all four
+ * terminal units in place of a TerminalDeviceDriver per unit; termInterrupt wakes
+ * writers itself and queues each unit's received characters for it
+ */
+#ifndef TERM_EVENT_LOOP
+#define TERM_EVENT_LOOP 0
+#endif
+
+#if TERM_EVENT_LOOP
+#define TERM_PENDING_SLOTS 16 // received characters queued per unit for the service process
+
+typedef struct TermPending
+{
+    char chars[TERM_PENDING_SLOTS];
+    int head;
+    int count;
+} TermPending;
+
+TermPending termPending[USLOSS_TERM_UNITS];
+KernelEvent termServiceEvent; // signalled when a character is queued for any unit
+
+static void termInterrupt(int dev, void *arg);
+#endif
+
+/*
+ * Built with DRIVERS_IN_INTERRUPT set, the clock and terminal drivers are not processes:
+ * their per-interrupt work is registered with registerInterruptDriver and runs in the
+ * interrupt itself, waking the processes it concerns directly
+ */
+#ifndef DRIVERS_IN_INTERRUPT
+#define DRIVERS_IN_INTERRUPT 0
+#endif
+
+#if DRIVERS_IN_INTERRUPT && TERM_EVENT_LOOP
+#error "TERM_EVENT_LOOP and DRIVERS_IN_INTERRUPT both replace the terminal driver processes"
+#endif
+
+typedef void (*InterruptDriver)(int unit, int status);
 
-int termWriteLocks[USLOSS_TERM_UNITS];      // write lock for each of 4 terminal devices
-int writeRequestMboxIDs[USLOSS_TERM_UNITS]; // holds mailbox ids for terminal write requests
+InterruptDriver interruptDrivers[USLOSS_NUM_INTS];                // state machine run for each interrupt, NULL if none
+void (*interruptChained[USLOSS_NUM_INTS])(int dev, void *arg);    // handler it replaced, run after it, NULL if none
 
-int readBuffersMbox[USLOSS_TERM_UNITS]; // mailbox id for 10 buffers for each unit
+#if DRIVERS_IN_INTERRUPT
+int clockLastTick;                     // currentTime() the last clock tick was due
+TermRxState termRx[USLOSS_TERM_UNITS]; // each unit's partial line
+
+static void clockInterruptDriver(int unit, int status);
+static void termInterruptDriver(int unit, int status);
+#endif
+
+#define MUTEX_BLOCK_STATUS 13  // blockMe status of a process waiting for a KernelMutex
+#define EVENT_BLOCK_STATUS 14  // blockMe status of a process waiting for a KernelEvent
+
+int waitNext[MAXPROC]; // next pid waiting on the same mutex or event, by pid % MAXPROC; 0 ends the list
+
+#define MUTEX_MAX_PROFILED 16 // kernel mutexes whose contention profile LockStats reports
+
+KernelMutex *mutexProfiled[MUTEX_MAX_PROFILED]; // every mutex initialized so far, in order
+int mutexProfiledCount = 0;
 
 int kernSleep(int seconds);
-void lock(int lockId);
-void unlock(int lockId);
 int clockDeviceDriver(char *arg);
+void registerInterruptDriver(int device, InterruptDriver driver, int chain);
 int TerminalDeviceDriver(char *arg);
+int TerminalServiceDriver(char *arg);
 void sleepHandler(USLOSS_Sysargs *sysargs);
 void termReadHandler(USLOSS_Sysargs *sysargs);
 void termWriteHandler(USLOSS_Sysargs *sysargs);
+void lockStatsHandler(USLOSS_Sysargs *sysargs);
+void phase4StatsHandler(USLOSS_Sysargs *sysargs);
+void phase4_disk_init(void);
+int DiskDeviceDriver(char *arg);
+void phase4_batch_init(void);
+void phase4_trace_init(void);
+void phase4_sysstats_init(void);
+void driverEnsure(int device, int unit);
+
+/*
+ * Devices whose drivers phase4_start_service_processes starts at boot, as a mask of
+ * 1 << the USLOSS device; any other driver is started by driverEnsure the first time
+ * a system call needs its unit, so a workload that never touches a device never
+ * creates its driver
+ */
+#ifndef PHASE4_EAGER_DEVICES
+#define PHASE4_EAGER_DEVICES ((1 << USLOSS_CLOCK_DEV) | (1 << USLOSS_TERM_DEV) | (1 << USLOSS_DISK_DEV))
+#endif
+
+typedef struct DriverEntry
+{
+    int device;
+    int unit;
+    char *name;
+    int (*func)(char *); // NULL for a driver that runs in its interrupt or in TerminalServiceDriver
+    char *arg;
+    int started;
+} DriverEntry;
+
+// the driver registry, in the order eager drivers are started
+DriverEntry drivers[] = {
+#if DRIVERS_IN_INTERRUPT
+    {USLOSS_CLOCK_DEV, 0, NULL, NULL, NULL, 0},
+#else
+    {USLOSS_CLOCK_DEV, 0, "ClockDeviceDriver", clockDeviceDriver, NULL, 0},
+#endif
+#if TERM_EVENT_LOOP || DRIVERS_IN_INTERRUPT
+    {USLOSS_TERM_DEV, 0, NULL, NULL, NULL, 0},
+    {USLOSS_TERM_DEV, 1, NULL, NULL, NULL, 0},
+    {USLOSS_TERM_DEV, 2, NULL, NULL, NULL, 0},
+    {USLOSS_TERM_DEV, 3, NULL, NULL, NULL, 0},
+#else
+    {USLOSS_TERM_DEV, 0, "TerminalDeviceDriver0", TerminalDeviceDriver, "0", 0},
+    {USLOSS_TERM_DEV, 1, "TerminalDeviceDriver1", TerminalDeviceDriver, "1", 0},
+    {USLOSS_TERM_DEV, 2, "TerminalDeviceDriver2", TerminalDeviceDriver, "2", 0},
+    {USLOSS_TERM_DEV, 3, "TerminalDeviceDriver3", TerminalDeviceDriver, "3", 0},
+#endif
+    {USLOSS_DISK_DEV, 0, "DiskDeviceDriver0", DiskDeviceDriver, "0", 0},
+    {USLOSS_DISK_DEV, 1, "DiskDeviceDriver1", DiskDeviceDriver, "1", 0},
+};
+
+#define DRIVER_COUNT ((int)(sizeof(drivers) / sizeof(drivers[0])))
+
+#if TERM_EVENT_LOOP
+int termServiceStarted = 0; // TerminalServiceDriver is started with the first terminal unit
+#endif
 
 /*
- * Initializes the phase 4 data structures and sets up the necessary mailboxes and locks
+ * Initializes the phase 4 data structures and sets up the necessary locks and events
  * It also initializes the system call vectors for sleep, terminal read, and terminal write handlers
- * Additionally, it enables interrupts for the terminal units
+ * and has the disk subsystem, the batched submission call, the trace ring and the
+ * system call accounting set up their own
+ * Interrupts for each terminal unit are enabled when its driver is started
  *
  * Returns: void
  */
 void phase4_init(void)
 {
     memset(sleepTable, 0, sizeof(sleepTable));
+    memset(termLines, 0, sizeof(termLines));
+    memset(termCounters, 0, sizeof(termCounters));
 
     systemCallVec[SYS_SLEEP] = sleepHandler;
     systemCallVec[SYS_TERMREAD] = termReadHandler;
     systemCallVec[SYS_TERMWRITE] = termWriteHandler;
+    systemCallVec[SYS_LOCKSTATS] = lockStatsHandler;
+    systemCallVec[SYS_PHASE4STATS] = phase4StatsHandler;
 
     // for sleep
-    sleep_lock = MboxCreate(1, 0);
+    kernMutexInit(&sleep_lock, "sleep");
+    for (int i = 0; i < MAXPROC; i++)
+    {
+        kernEventInit(&sleepEvents[i]);
+    }
+    kernEventInit(&clockTickEvent);
 
     // for terminal
     for (int i = 0; i < USLOSS_TERM_UNITS; i++)
     {
-        termWriteLocks[i] = MboxCreate(1, 0);
-        writeRequestMboxIDs[i] = MboxCreate(0, 0);
+        char name[LOCK_NAME_LEN];
+        snprintf(name, sizeof(name), "termWrite%d", i);
+        kernMutexInit(&termWriteLocks[i], name);
+        kernEventInit(&termXmitEvents[i]);
+
+        kernEventInit(&termLineEvents[i]);
+    }
+#if TERM_EVENT_LOOP
+    memset(termPending, 0, sizeof(termPending));
+    kernEventInit(&termServiceEvent);
+    USLOSS_IntVec[USLOSS_TERM_INT] = termInterrupt;
+#endif
+#if DRIVERS_IN_INTERRUPT
+    // phase 2's clock handler still runs after the clock's state machine, for time slicing
+    clockLastTick = currentTime();
+    registerInterruptDriver(USLOSS_CLOCK_DEV, clockInterruptDriver, 1);
+    memset(termRx, 0, sizeof(termRx));
+    registerInterruptDriver(USLOSS_TERM_DEV, termInterruptDriver, 0);
+#endif
+
+    // for disk
+    phase4_disk_init();
+
+    // for batched submission
+    phase4_batch_init();
+
+    // for the trace ring
+    phase4_trace_init();
+
+    // last, so the accounting wraps every handler above
+    phase4_sysstats_init();
+}
+
+/*
+ * Starts the driver for a registry entry, once
+ * The process is created before a terminal unit's interrupts are enabled, so
+ * no interrupt arrives without a driver to take it
+ *
+ * Parameters:
+ *   entry - the registry entry
+ *
+ * Returns: void
+ */
+static void driverStart(DriverEntry *entry)
+{
+    unsigned int psr = USLOSS_PsrGet();
+    USLOSS_PsrSet(psr & ~USLOSS_PSR_CURRENT_INT);
+
+    int already = entry->started;
+    entry->started = 1;
+#if TERM_EVENT_LOOP
+    int startService = entry->device == USLOSS_TERM_DEV && !termServiceStarted;
+    if (startService)
+    {
+        termServiceStarted = 1;
+    }
+#endif
+
+    USLOSS_PsrSet(psr);
+
+    if (already)
+    {
+        return;
+    }
 
-        readBuffersMbox[i] = MboxCreate(10, MAXLINE);
+    if (entry->func != NULL)
+    {
+        spork(entry->name, entry->func, entry->arg, USLOSS_MIN_STACK, 1);
+    }
+#if TERM_EVENT_LOOP
+    if (startService)
+    {
+        spork("TerminalServiceDriver", TerminalServiceDriver, NULL, USLOSS_MIN_STACK, 1);
     }
+#endif
 
-    // enabling interrupts for terminal units
-    int control = 0;
-    control = USLOSS_TERM_CTRL_XMIT_INT(control);
-    control = USLOSS_TERM_CTRL_RECV_INT(control);
+    // enabling interrupts for the terminal unit
+    if (entry->device == USLOSS_TERM_DEV)
+    {
+        int control = 0;
+        control = USLOSS_TERM_CTRL_XMIT_INT(control);
+        control = USLOSS_TERM_CTRL_RECV_INT(control);
+
+        USLOSS_DeviceOutput(USLOSS_TERM_DEV, entry->unit, (void *)(long)control);
+    }
+}
 
-    USLOSS_DeviceOutput(USLOSS_TERM_DEV, 0, (void *)(long)control);
-    USLOSS_DeviceOutput(USLOSS_TERM_DEV, 1, (void *)(long)control);
-    USLOSS_DeviceOutput(USLOSS_TERM_DEV, 2, (void *)(long)control);
-    USLOSS_DeviceOutput(USLOSS_TERM_DEV, 3, (void *)(long)control);
+/*
+ * Makes sure the driver for a device unit is running, starting it if this is the
+ * first call that needs it
+ *
+ * Parameters:
+ *   device - the USLOSS device
+ *   unit - the unit of that device
+ *
+ * Returns: void
+ */
+void driverEnsure(int device, int unit)
+{
+    for (int i = 0; i < DRIVER_COUNT; i++)
+    {
+        if (drivers[i].device == device && drivers[i].unit == unit)
+        {
+            if (!drivers[i].started)
+            {
+                driverStart(&drivers[i]);
+            }
+            return;
+        }
+    }
 }
 
 /*
- * Starts the phase 4 service processes, including the clock device driver and
- * the terminal device drivers for each of the four terminal units
+ * Starts the phase 4 service processes for every device in PHASE4_EAGER_DEVICES,
+ * by default the clock device driver, the terminal device drivers for each of the
+ * four terminal units (or the one terminal service process built with TERM_EVENT_LOOP)
+ * and the disk device drivers for each of the two disk units
+ * The rest are started on demand by driverEnsure
  * These processes are created using the spork function
  *
  * Returns: void
  */
 void phase4_start_service_processes(void)
 {
-    spork("ClockDeviceDriver", clockDeviceDriver, NULL, USLOSS_MIN_STACK, 1);
-    spork("TerminalDeviceDriver0", TerminalDeviceDriver, "0", USLOSS_MIN_STACK, 1);
-    spork("TerminalDeviceDriver1", TerminalDeviceDriver, "1", USLOSS_MIN_STACK, 1);
-    spork("TerminalDeviceDriver2", TerminalDeviceDriver, "2", USLOSS_MIN_STACK, 1);
-    spork("TerminalDeviceDriver3", TerminalDeviceDriver, "3", USLOSS_MIN_STACK, 1);
+    for (int i = 0; i < DRIVER_COUNT; i++)
+    {
+        if (PHASE4_EAGER_DEVICES & (1 << drivers[i].device))
+        {
+            driverStart(&drivers[i]);
+        }
+    }
+}
+
+/*
+ * Adds a completed line to a terminal unit's line buffers and wakes a reader
+ * The line is dropped if all of the unit's buffers are full
+ *
+ * Parameters:
+ *   unitID - the terminal unit
+ *   line - the characters of the line
+ *   length - the number of characters
+ *
+ * Returns: void
+ */
+static void termPutLine(int unitID, char *line, int length)
+{
+    TermLines *t = &termLines[unitID];
+
+    unsigned int psr = USLOSS_PsrGet();
+    USLOSS_PsrSet(psr & ~USLOSS_PSR_CURRENT_INT);
+
+    int stored = 0;
+    if (t->count < TERM_LINE_SLOTS)
+    {
+        int slot = (t->head + t->count) % TERM_LINE_SLOTS;
+        memcpy(t->lines[slot], line, length);
+        t->lengths[slot] = length;
+        t->count++;
+        stored = 1;
+        termCounters[unitID].linesIn++;
+    }
+    else
+    {
+        termCounters[unitID].linesDropped++;
+    }
+    TRACE(TRACE_CLASS_TERM, stored ? TRACE_LINE_DELIVERED : TRACE_LINE_DROPPED, unitID, length, t->count);
+
+    USLOSS_PsrSet(psr);
+
+    if (stored)
+    {
+        kernEventSignal(&termLineEvents[unitID]);
+    }
+}
+
+/*
+ * Removes the oldest line from a terminal unit's line buffers
+ *
+ * Parameters:
+ *   unitID - the terminal unit
+ *   line - receives the characters of the line, MAXLINE at most
+ *
+ * Returns:
+ *   int - the number of characters in the line, -1 if there is no line yet
+ */
+static int termTakeLine(int unitID, char *line)
+{
+    TermLines *t = &termLines[unitID];
+    int length = -1;
+
+    unsigned int psr = USLOSS_PsrGet();
+    USLOSS_PsrSet(psr & ~USLOSS_PSR_CURRENT_INT);
+
+    if (t->count > 0)
+    {
+        length = t->lengths[t->head];
+        memcpy(line, t->lines[t->head], length);
+        t->head = (t->head + 1) % TERM_LINE_SLOTS;
+        t->count--;
+    }
+
+    USLOSS_PsrSet(psr);
+    return length;
+}
+
+/*
+ * Adds a received character to a unit's partial line, which is handed to
+ * kernTermRead's line buffers when a newline is encountered or the line is full
+ *
+ * Parameters:
+ *   unitID - the terminal unit
+ *   receivedChar - the character
+ *   rx - the unit's partial line
+ *
+ * Returns: void
+ */
+static void termReceiveChar(int unitID, char receivedChar, TermRxState *rx)
+{
+    termCounters[unitID].charsIn++;
+    rx->buff[rx->length] = receivedChar;
+    rx->length += 1;
+
+    // deliver buffer to kernRead if new line character or buffer size reached limit
+    if (receivedChar == '\n' || rx->length == MAXLINE)
+    {
+
+        // hand the line to kernTermRead
+        termPutLine(unitID, rx->buff, rx->length);
+        rx->length = 0;
+    }
+}
+
+/*
+ * Handles one terminal interrupt for a unit
+ * If a character is received, it is added to the unit's partial line
+ * If the terminal is ready for writing, it wakes the writer waiting to send the next character
+ *
+ * Parameters:
+ *   unitID - the terminal unit
+ *   status - the unit's status register at the interrupt
+ *   rx - the unit's partial line
+ *
+ * Returns: void
+ */
+static void termHandleStatus(int unitID, int status, TermRxState *rx)
+{
+    // checks if terminal interrupt needs to read a character
+    if (USLOSS_TERM_STAT_RECV(status) == USLOSS_DEV_BUSY)
+    {
+        termReceiveChar(unitID, USLOSS_TERM_STAT_CHAR(status), rx);
+    }
+
+    // checks if terminal is ready for writing a character
+    if (USLOSS_TERM_STAT_XMIT(status) == USLOSS_DEV_READY)
+    {
+        kernEventSignal(&termXmitEvents[unitID]);
+    }
 }
 
 /*
  * Handles the terminal device driver functionality for a specific terminal unit
  * It continuously waits for interrupts from the terminal and processes them accordingly
- * If a character is received, it is added to the buffer and sent to the read mailbox if a newline is encountered or the buffer is full
- * If the terminal is ready for writing, it sends a message to the write request mailbox
  *
  * Parameters:
  *   arg - a string representing the terminal unit number
@@ -125,46 +510,132 @@ int TerminalDeviceDriver(char *arg)
 {
     int unitID = atoi(arg);
     int status;
-    char buff[MAXLINE] = "";
-    int length = 0;
+    TermRxState rx = {.length = 0};
 
     while (1)
     {
         waitDevice(USLOSS_TERM_DEV, unitID, &status);
+        TRACE(TRACE_CLASS_INTERRUPT, TRACE_INTERRUPT, USLOSS_TERM_DEV, unitID, status);
 
-        // checks if terminal interrupt needs to read a character
-        if (USLOSS_TERM_STAT_RECV(status) == USLOSS_DEV_BUSY)
-        {
+        termHandleStatus(unitID, status, &rx);
+    }
 
-            // get character from status register
-            char receivedChar = USLOSS_TERM_STAT_CHAR(status);
-            buff[length] = receivedChar;
-            length += 1;
+    return 0;
+}
 
-            // deliver buffer to kernRead if new line character or buffer size reached limit
-            if (receivedChar == '\n' || length == MAXLINE)
-            {
+#if TERM_EVENT_LOOP
+/*
+ * Terminal interrupt handler installed in place of phase 2's when the terminals share
+ * one service process
+ * It reads the unit's status register and wakes the unit's writer itself, so a ready
+ * transmitter is never lost; a received character is queued for the service process,
+ * or counted as overrun if the unit's queue is full
+ *
+ * Parameters:
+ *   dev - the interrupting device, always USLOSS_TERM_DEV
+ *   arg - the interrupting unit
+ *
+ * Returns: void
+ */
+static void termInterrupt(int dev, void *arg)
+{
+    int unitID = (int)(long)arg;
+    int status;
 
-                // send buffer to mailbox
-                MboxCondSend(readBuffersMbox[unitID], buff, length);
-                strcpy(buff, "");
-                length = 0;
-            }
+    USLOSS_DeviceInput(USLOSS_TERM_DEV, unitID, &status);
+    TRACE(TRACE_CLASS_INTERRUPT, TRACE_INTERRUPT, USLOSS_TERM_DEV, unitID, status);
+
+    if (USLOSS_TERM_STAT_XMIT(status) == USLOSS_DEV_READY)
+    {
+        kernEventSignal(&termXmitEvents[unitID]);
+    }
+
+    if (USLOSS_TERM_STAT_RECV(status) == USLOSS_DEV_BUSY)
+    {
+        TermPending *p = &termPending[unitID];
+        if (p->count < TERM_PENDING_SLOTS)
+        {
+            p->chars[(p->head + p->count) % TERM_PENDING_SLOTS] = USLOSS_TERM_STAT_CHAR(status);
+            p->count++;
+        }
+        else
+        {
+            termCounters[unitID].charsOverrun++;
         }
 
-        // checks if terminal is ready for writing a character
-        if (USLOSS_TERM_STAT_XMIT(status) == USLOSS_DEV_READY)
+        kernEventSignal(&termServiceEvent);
+    }
+}
+
+/*
+ * Takes the oldest queued received character of a terminal unit
+ *
+ * Parameters:
+ *   unitID - the terminal unit
+ *   receivedChar - receives the character
+ *
+ * Returns:
+ *   int - 1 if there was a character, 0 if the unit's queue was empty
+ */
+static int termTakeChar(int unitID, char *receivedChar)
+{
+    TermPending *p = &termPending[unitID];
+    int found = 0;
+
+    unsigned int psr = USLOSS_PsrGet();
+    USLOSS_PsrSet(psr & ~USLOSS_PSR_CURRENT_INT);
+
+    if (p->count > 0)
+    {
+        *receivedChar = p->chars[p->head];
+        p->head = (p->head + 1) % TERM_PENDING_SLOTS;
+        p->count--;
+        found = 1;
+    }
+
+    USLOSS_PsrSet(psr);
+    return found;
+}
+
+/*
+ * Handles the terminal device driver functionality for all four terminal units
+ * in one process
+ * It waits until termInterrupt has queued a received character for any unit, then
+ * adds each unit's queued characters to its partial line as TerminalDeviceDriver does
+ *
+ * Parameters:
+ *   arg - unused parameter, provided for consistency with other device driver functions
+ *
+ * Returns:
+ *   int - always returns 0
+ */
+int TerminalServiceDriver(char *arg)
+{
+    TermRxState rx[USLOSS_TERM_UNITS];
+    char receivedChar;
+
+    memset(rx, 0, sizeof(rx));
+
+    while (1)
+    {
+        kernEventWait(&termServiceEvent);
+
+        for (int unitID = 0; unitID < USLOSS_TERM_UNITS; unitID++)
         {
-            MboxCondSend(writeRequestMboxIDs[unitID], NULL, 0);
+            while (termTakeChar(unitID, &receivedChar))
+            {
+                termReceiveChar(unitID, receivedChar, &rx[unitID]);
+            }
         }
     }
 
     return 0;
 }
+#endif
 
 /*
  * Reads a line of input from the specified terminal unit and stores it in the provided buffer
- * It retrieves the input from the corresponding read buffer mailbox
+ * It takes the oldest line from the unit's line buffers, waiting for one if there is none
  * The function copies the characters from the read buffer to the user-provided buffer, up to the specified buffer size
  * It also sets the number of characters read in the numCharsRead pointer
  *
@@ -184,8 +655,13 @@ int kernTermRead(char *buffer, int bufferSize, int unitID, int *numCharsRead)
         return -1;
     }
 
+    driverEnsure(USLOSS_TERM_DEV, unitID);
+
     char readBuff[MAXLINE + 1];
-    *numCharsRead = MboxRecv(readBuffersMbox[unitID], readBuff, MAXLINE);
+    while ((*numCharsRead = termTakeLine(unitID, readBuff)) < 0)
+    {
+        kernEventWait(&termLineEvents[unitID]);
+    }
 
     // copy only characters up to bufferSize given by user
     memcpy(buffer, readBuff, bufferSize);
@@ -201,7 +677,7 @@ int kernTermRead(char *buffer, int bufferSize, int unitID, int *numCharsRead)
 
 /*
  * Writes the contents of the provided buffer to the specified terminal unit
- * It acquires the write lock for the terminal unit before writing
+ * The caller must hold the write lock for the terminal unit (see kernTermWriteLocked)
  * The function iterates through the buffer and writes each character to the terminal
  * It waits for the terminal to be ready for writing before sending each character
  * The number of characters written is stored in the numCharsWritten pointer
@@ -224,12 +700,14 @@ int kernTermWrite(char *buffer, int bufferSize, int unitID, int *numCharsWritten
         return -1;
     }
 
+    driverEnsure(USLOSS_TERM_DEV, unitID);
+
     // USLOSS_Console("beginnging to copy characters to term %d\n", unitID);
     for (int i = 0; i < bufferSize; i++)
     {
 
         // wait to write
-        MboxRecv(writeRequestMboxIDs[unitID], NULL, 0);
+        kernEventWait(&termXmitEvents[unitID]);
 
         int control = 0x1;
         control |= 0x2;
@@ -241,6 +719,8 @@ int kernTermWrite(char *buffer, int bufferSize, int unitID, int *numCharsWritten
             return -1;
         }
         *numCharsWritten += 1;
+        termCounters[unitID].charsOut++;
+        TRACE(TRACE_CLASS_TERM, TRACE_CHAR_XMIT, unitID, buffer[i], *numCharsWritten);
     }
     return 0;
 }
@@ -270,11 +750,39 @@ void termReadHandler(USLOSS_Sysargs *sysargs)
     sysargs->arg4 = (void *)(long)res;
 }
 
+/*
+ * Writes a buffer to a terminal unit while holding the unit's write lock, so the
+ * characters of one write are never interleaved with those of another
+ * Every path into kernTermWrite goes through here
+ *
+ * Parameters:
+ *   buffer - a character array containing the data to be written
+ *   bufferSize - the size of the provided buffer
+ *   unitID - the ID of the terminal unit to write to
+ *   numCharsWritten - a pointer to an integer to store the number of characters written
+ *
+ * Returns:
+ *   int - returns 0 on success, -1 if invalid parameters are provided
+ */
+int kernTermWriteLocked(char *buffer, int bufferSize, int unitID, int *numCharsWritten)
+{
+    // an invalid unit has no lock; kernTermWrite rejects it
+    if (unitID < 0 || unitID >= USLOSS_TERM_UNITS)
+    {
+        return -1;
+    }
+
+    kernMutexLock(&termWriteLocks[unitID]);
+    int res = kernTermWrite(buffer, bufferSize, unitID, numCharsWritten);
+    kernMutexUnlock(&termWriteLocks[unitID]);
+    return res;
+}
+
 /*
  * System call handler for the terminal write operation
  * It extracts the necessary arguments from the USLOSS_Sysargs structure
- * and calls the kernTermWrite function with the provided arguments
- * The result of the kernTermWrite function is stored back in the USLOSS_Sysargs structure
+ * and calls the kernTermWriteLocked function with the provided arguments
+ * The result of the kernTermWriteLocked function is stored back in the USLOSS_Sysargs structure
  *
  * Parameters:
  *   sysargs - pointer to the USLOSS_Sysargs structure containing the system call arguments
@@ -290,16 +798,102 @@ void termWriteHandler(USLOSS_Sysargs *sysargs)
     int unitID = (int)(long)sysargs->arg3;
     int numCharsWritten = 0;
 
-    // USLOSS_Console("acquiring lock kernTermWrite for unit %d\n", unitID);
-    lock(termWriteLocks[unitID]);
-    int res = kernTermWrite(buffer, bufferSize, unitID, &numCharsWritten);
-    // USLOSS_Console("releading lock kernTermWritefor unit %d\n", unitID);
-    unlock(termWriteLocks[unitID]);
+    int res = kernTermWriteLocked(buffer, bufferSize, unitID, &numCharsWritten);
 
     sysargs->arg2 = (void *)(long)numCharsWritten;
     sysargs->arg4 = (void *)(long)res;
 }
 
+/*
+ * System call handler for the lock statistics operation
+ *
+ * Parameters:
+ *   sysargs - pointer to the USLOSS_Sysargs structure containing the system call arguments
+ *
+ * Returns:
+ *   void
+ */
+void lockStatsHandler(USLOSS_Sysargs *sysargs)
+{
+    LockStatsEntry *entries = (LockStatsEntry *)sysargs->arg1;
+    int max = (int)(long)sysargs->arg2;
+    int count = 0;
+
+    int res = kernLockStats(entries, max, &count);
+
+    sysargs->arg1 = (void *)(long)count;
+    sysargs->arg4 = (void *)(long)res;
+}
+
+/*
+ * Fills in a snapshot of the clock, terminal and disk counters
+ * The disk counters are copied under the disk lock first; the clock and
+ * terminal counters are then copied together with interrupts masked, so
+ * no driver can change them part way through
+ *
+ * Parameters:
+ *   stats - the structure to fill in
+ *
+ * Returns:
+ *   int - returns 0 on success, -1 if invalid parameters are provided
+ */
+int kernGetPhase4Stats(Phase4Stats *stats)
+{
+    if (stats == NULL)
+    {
+        return -1;
+    }
+
+    memset(stats, 0, sizeof(Phase4Stats));
+    stats->version = PHASE4_STATS_VERSION;
+    stats->size = sizeof(Phase4Stats);
+
+    for (int unit = 0; unit < USLOSS_DISK_UNITS; unit++)
+    {
+        DiskUnitStats disk;
+        kernDiskStats(unit, &disk);
+
+        Phase4DiskCounters *d = &stats->disk[unit];
+        d->ops = disk.ops;
+        d->sectors = disk.sectors;
+        d->queueDepth = disk.queueDepth;
+        d->maxQueueDepth = disk.maxQueueDepth;
+        d->cacheHits = disk.cacheHits;
+        d->readAheads = disk.readAheads;
+        d->cacheEvictions = disk.cacheEvictions;
+    }
+
+    unsigned int psr = USLOSS_PsrGet();
+    USLOSS_PsrSet(psr & ~USLOSS_PSR_CURRENT_INT);
+
+    stats->clockTicks = clock_ticks;
+    stats->sleepers = totalSleepingProcs;
+    for (int unit = 0; unit < USLOSS_TERM_UNITS; unit++)
+    {
+        stats->term[unit] = termCounters[unit];
+        stats->term[unit].linesQueued = termLines[unit].count;
+    }
+
+    USLOSS_PsrSet(psr);
+    return 0;
+}
+
+/*
+ * System call handler for the phase 4 statistics snapshot
+ *
+ * Parameters:
+ *   sysargs - pointer to the USLOSS_Sysargs structure containing the system call arguments
+ *
+ * Returns:
+ *   void
+ */
+void phase4StatsHandler(USLOSS_Sysargs *sysargs)
+{
+    Phase4Stats *stats = (Phase4Stats *)sysargs->arg1;
+
+    sysargs->arg4 = (void *)(long)kernGetPhase4Stats(stats);
+}
+
 /*
  * System call handler for the sleep operation
  * It extracts the necessary arguments from the USLOSS_Sysargs structure
@@ -321,12 +915,73 @@ void sleepHandler(USLOSS_Sysargs *sysargs)
     sysargs->arg4 = (void *)(long)res;
 }
 
+/*
+ * Takes the sleep queue for the caller
+ * The clock's state machine cannot wait for a mutex when it runs in the clock
+ * interrupt, so with DRIVERS_IN_INTERRUPT interrupts are masked instead of taking
+ * the sleep_lock
+ *
+ * Returns:
+ *   unsigned int - what sleepQueueUnlock needs to give the queue back
+ */
+static unsigned int sleepQueueLock(void)
+{
+#if DRIVERS_IN_INTERRUPT
+    unsigned int psr = USLOSS_PsrGet();
+    USLOSS_PsrSet(psr & ~USLOSS_PSR_CURRENT_INT);
+    return psr;
+#else
+    kernMutexLock(&sleep_lock);
+    return 0;
+#endif
+}
+
+/*
+ * Gives back the sleep queue taken with sleepQueueLock
+ *
+ * Parameters:
+ *   psr - what sleepQueueLock returned
+ *
+ * Returns: void
+ */
+static void sleepQueueUnlock(unsigned int psr)
+{
+#if DRIVERS_IN_INTERRUPT
+    USLOSS_PsrSet(psr);
+#else
+    kernMutexUnlock(&sleep_lock);
+#endif
+}
+
+/*
+ * Advances the clock by one tick
+ * It increments the clock_ticks counter, wakes up any processes whose sleep time has
+ * expired and wakes every process waiting in kernClockWait
+ * The caller must hold the sleep queue
+ *
+ * Returns: void
+ */
+static void clockTick(void)
+{
+    clock_ticks++;
+
+    // iterating through the sleep queue to wake up any processes whose time is up
+    while (sleepQueue != NULL && sleepQueue->wakeupTime <= clock_ticks)
+    {
+        SleepProc *toWake = sleepQueue;
+        TRACE(TRACE_CLASS_SLEEP, TRACE_SLEEP_WAKE, toWake->pid, toWake->wakeupTime, clock_ticks);
+        kernEventSignal(&sleepEvents[toWake->pid % MAXPROC]);
+        sleepQueue = sleepQueue->next;
+        totalSleepingProcs--;
+    }
+
+    kernEventSignalAll(&clockTickEvent);
+}
+
 /*
  * Handles the clock device driver functionality
- * It continuously waits for interrupts from the clock device
- * Upon receiving an interrupt, it increments the clock_ticks counter
- * and checks the sleep queue to wake up any processes whose sleep time has expired
- * The function acquires and releases the sleep_lock to ensure thread safety
+ * It continuously waits for interrupts from the clock device and advances the
+ * clock by a tick for each one
  *
  * Parameters:
  *   arg - unused parameter, provided for consistency with other device driver functions
@@ -340,29 +995,118 @@ int clockDeviceDriver(char *arg)
     while (1)
     {
         waitDevice(USLOSS_CLOCK_DEV, 0, &status);
+        TRACE(TRACE_CLASS_INTERRUPT, TRACE_INTERRUPT, USLOSS_CLOCK_DEV, 0, status);
+
+        unsigned int psr = sleepQueueLock();
+        clockTick();
+        sleepQueueUnlock(psr);
+    }
 
-        lock(sleep_lock);
-        clock_ticks++;
+    return 0;
+}
 
-        // iterating through the sleep queue to wake up any processes whose time is up
-        while (sleepQueue != NULL && sleepQueue->wakeupTime <= clock_ticks)
-        {
-            SleepProc *toWake = sleepQueue;
-            unblockProc(toWake->pid);
-            sleepQueue = sleepQueue->next;
-        }
+/*
+ * Waits for the next clock tick
+ * A tick that passed while no one was waiting ends the wait at once
+ *
+ * Returns: void
+ */
+void kernClockWait(void)
+{
+    kernEventWait(&clockTickEvent);
+}
 
-        unlock(sleep_lock);
+/*
+ * Runs the state machine registered for an interrupt, then the handler it replaced
+ * It reads the interrupting unit's status register for the state machine
+ *
+ * Parameters:
+ *   dev - the interrupting device
+ *   arg - the interrupting unit
+ *
+ * Returns: void
+ */
+static void interruptDispatch(int dev, void *arg)
+{
+    int unit = (int)(long)arg;
+    int status;
+
+    USLOSS_DeviceInput(dev, unit, &status);
+    TRACE(TRACE_CLASS_INTERRUPT, TRACE_INTERRUPT, dev, unit, status);
+
+    interruptDrivers[dev](unit, status);
+
+    if (interruptChained[dev] != NULL)
+    {
+        interruptChained[dev](dev, arg);
     }
+}
 
-    return 0;
+/*
+ * Registers a driver as a state machine run in its device's interrupt
+ * The state machine runs with interrupts masked and must not block; it may only
+ * touch state that is otherwise guarded by masking interrupts, and wakes the
+ * processes it concerns with kernEventSignal
+ *
+ * Parameters:
+ *   device - the USLOSS device, which is also its interrupt
+ *   driver - called with the interrupting unit and its status on each interrupt
+ *   chain - 1 to keep running the handler already installed after the driver,
+ *           0 to replace it
+ *
+ * Returns: void
+ */
+void registerInterruptDriver(int device, InterruptDriver driver, int chain)
+{
+    interruptDrivers[device] = driver;
+    interruptChained[device] = chain ? USLOSS_IntVec[device] : NULL;
+    USLOSS_IntVec[device] = interruptDispatch;
 }
 
+#if DRIVERS_IN_INTERRUPT
+/*
+ * The clock driver's state machine
+ * The clock interrupts more often than Sleep counts, so it advances the clock by a
+ * tick whenever CLOCK_TICK_US has passed since the last one was due
+ *
+ * Parameters:
+ *   unit - the clock unit, always 0
+ *   status - the clock's status register, the current time
+ *
+ * Returns: void
+ */
+static void clockInterruptDriver(int unit, int status)
+{
+    if (status - clockLastTick < CLOCK_TICK_US)
+    {
+        return;
+    }
+    clockLastTick += CLOCK_TICK_US;
+
+    // interrupts are already masked
+    clockTick();
+}
+
+/*
+ * The terminal driver's state machine, run for every terminal interrupt
+ *
+ * Parameters:
+ *   unit - the interrupting terminal unit
+ *   status - the unit's status register
+ *
+ * Returns: void
+ */
+static void termInterruptDriver(int unit, int status)
+{
+    termHandleStatus(unit, status, &termRx[unit]);
+}
+#endif
+
 /*
  * Puts the current process to sleep for the specified number of seconds
  * It calculates the wake-up time based on the current clock ticks and the requested sleep duration
  * The function creates a SleepProc structure to store the process information and adds it to the sleep queue
- * It acquires and releases the sleep_lock to ensure thread safety
+ * It holds the sleep queue with sleepQueueLock while it inserts the process
  * The process is then blocked until it is woken up by the clock device driver
  *
  * Parameters:
@@ -373,14 +1117,16 @@ int clockDeviceDriver(char *arg)
  */
 int kernSleep(int seconds)
 {
-    lock(sleep_lock);
-
     // invalid argument
     if (seconds < 0)
     {
         return -1;
     }
 
+    driverEnsure(USLOSS_CLOCK_DEV, 0);
+
+    unsigned int psr = sleepQueueLock();
+
     int wakeup_tick = clock_ticks + (seconds * 10);
     int cur_pid = getpid();
 
@@ -419,47 +1165,329 @@ int kernSleep(int seconds)
     }
 
     totalSleepingProcs++;
+    TRACE(TRACE_CLASS_SLEEP, TRACE_SLEEP_ENQUEUE, cur_pid, wakeup_tick, clock_ticks);
 
-    unlock(sleep_lock);
-    blockMe(12);
+    // a wakeup that lands before the wait is remembered by the event
+    sleepQueueUnlock(psr);
+    kernEventWait(&sleepEvents[cur_pid % MAXPROC]);
 
     return 0;
 }
 
-/**
- * Locks a mailbox acting as a mutex.
+/*
+ * Appends a pid to a FIFO of waiters linked through waitNext
+ * Interrupts must already be masked
+ *
+ * Parameters:
+ *   head - the FIFO's first pid, 0 if it is empty
+ *   tail - the FIFO's last pid, 0 if it is empty
+ *   pid - the pid to append
  *
- * @param lockId The mailbox ID to be locked.
+ * Returns: void
  */
-void lock(int lockId)
+static void waitAppend(int *head, int *tail, int pid)
 {
-    MboxSend(lockId, NULL, 0);
+    waitNext[pid % MAXPROC] = 0;
+    if (*tail == 0)
+    {
+        *head = pid;
+    }
+    else
+    {
+        waitNext[*tail % MAXPROC] = pid;
+    }
+    *tail = pid;
 }
 
-/**
- * Unlocks a mailbox acting as a mutex.
+/*
+ * Removes the first pid from a FIFO of waiters linked through waitNext
+ * Interrupts must already be masked
+ *
+ * Parameters:
+ *   head - the FIFO's first pid, must not be 0
+ *   tail - the FIFO's last pid
  *
- * @param lockId The mailbox ID to be unlocked.
+ * Returns:
+ *   int - the pid removed
  */
-void unlock(int lockId)
+static int waitRemoveHead(int *head, int *tail)
 {
-    MboxRecv(lockId, NULL, 0);
+    int pid = *head;
+    *head = waitNext[pid % MAXPROC];
+    if (*head == 0)
+    {
+        *tail = 0;
+    }
+    return pid;
 }
 
-// 4b
-int kernDiskRead(void *diskBuffer, int unit, int track, int first, int sectors, int *status)
+/*
+ * Initializes a kernel mutex as unlocked with no waiters and registers it for
+ * contention profiling under the given name
+ *
+ * Parameters:
+ *   mutex - the mutex
+ *   name - the name LockStats reports it under
+ *
+ * Returns: void
+ */
+void kernMutexInit(KernelMutex *mutex, char *name)
 {
-    return 0;
+    mutex->holder = 0;
+    mutex->head = 0;
+    mutex->tail = 0;
+    mutex->acquiredAt = 0;
+    memset(&mutex->stats, 0, sizeof(LockStatsEntry));
+    strncpy(mutex->stats.name, name, LOCK_NAME_LEN - 1);
+
+    if (mutexProfiledCount < MUTEX_MAX_PROFILED)
+    {
+        mutexProfiled[mutexProfiledCount++] = mutex;
+    }
 }
 
-// 4b
-int kernDiskWrite(void *diskBuffer, int unit, int track, int first, int sectors, int *status)
+/*
+ * Acquires a kernel mutex, blocking until it is free
+ * Interrupts are masked while the mutex is examined, so no other process can
+ * run in between; a free mutex costs nothing more than that
+ * A process that finds it held joins the FIFO of waiters and blocks, and is
+ * handed the mutex directly by kernMutexUnlock before it is woken
+ * Every acquisition is counted in the mutex's profile, along with how long a
+ * contended one waited
+ *
+ * Parameters:
+ *   mutex - the mutex
+ *
+ * Returns: void
+ */
+void kernMutexLock(KernelMutex *mutex)
 {
-    return 0;
+    unsigned int psr = USLOSS_PsrGet();
+    USLOSS_PsrSet(psr & ~USLOSS_PSR_CURRENT_INT);
+
+    int cur_pid = getpid();
+    int started = currentTime();
+
+    mutex->stats.acquisitions++;
+    if (mutex->holder == 0)
+    {
+        mutex->holder = cur_pid;
+        mutex->acquiredAt = started;
+    }
+    else
+    {
+        waitAppend(&mutex->head, &mutex->tail, cur_pid);
+
+        blockMe(MUTEX_BLOCK_STATUS);
+
+        // kernMutexUnlock stamped acquiredAt when it handed the mutex over
+        int waited = mutex->acquiredAt - started;
+        mutex->stats.contended++;
+        mutex->stats.waitTotal += waited;
+        if (waited > mutex->stats.waitMax)
+        {
+            mutex->stats.waitMax = waited;
+        }
+    }
+
+    USLOSS_PsrSet(psr);
+}
+
+/*
+ * Releases a kernel mutex, handing it to the longest waiter if there is one
+ * The time it was held is added to its profile
+ *
+ * Parameters:
+ *   mutex - the mutex
+ *
+ * Returns: void
+ */
+void kernMutexUnlock(KernelMutex *mutex)
+{
+    unsigned int psr = USLOSS_PsrGet();
+    USLOSS_PsrSet(psr & ~USLOSS_PSR_CURRENT_INT);
+
+    int now = currentTime();
+    int held = now - mutex->acquiredAt;
+    mutex->stats.holdTotal += held;
+    if (held > mutex->stats.holdMax)
+    {
+        mutex->stats.holdMax = held;
+    }
+
+    int next = mutex->head;
+    if (next == 0)
+    {
+        mutex->holder = 0;
+    }
+    else
+    {
+        waitRemoveHead(&mutex->head, &mutex->tail);
+
+        // the waiter owns the mutex before it runs again
+        mutex->holder = next;
+        mutex->acquiredAt = now;
+        unblockProc(next);
+    }
+
+    USLOSS_PsrSet(psr);
+}
+
+/*
+ * Initializes a kernel event as unsignalled with no waiters
+ *
+ * Parameters:
+ *   event - the event
+ *
+ * Returns: void
+ */
+void kernEventInit(KernelEvent *event)
+{
+    event->signalled = 0;
+    event->head = 0;
+    event->tail = 0;
 }
 
-// 4b
-int kernDiskSize(int unit, int *sector, int *track, int *disk)
+/*
+ * Waits for a kernel event to be signalled
+ * If a signal arrived while no one was waiting it is consumed and the wait
+ * returns at once; otherwise the process joins the FIFO of waiters and blocks
+ * Callers recheck whatever condition they were waiting for, since one signal
+ * may stand for several changes
+ *
+ * Parameters:
+ *   event - the event
+ *
+ * Returns: void
+ */
+void kernEventWait(KernelEvent *event)
 {
+    unsigned int psr = USLOSS_PsrGet();
+    USLOSS_PsrSet(psr & ~USLOSS_PSR_CURRENT_INT);
+
+    if (event->signalled)
+    {
+        event->signalled = 0;
+    }
+    else
+    {
+        waitAppend(&event->head, &event->tail, getpid());
+        blockMe(EVENT_BLOCK_STATUS);
+    }
+
+    USLOSS_PsrSet(psr);
+}
+
+/*
+ * Signals a kernel event, waking its longest waiter
+ * With no one waiting the event stays signalled until the next wait
+ *
+ * Parameters:
+ *   event - the event
+ *
+ * Returns: void
+ */
+void kernEventSignal(KernelEvent *event)
+{
+    unsigned int psr = USLOSS_PsrGet();
+    USLOSS_PsrSet(psr & ~USLOSS_PSR_CURRENT_INT);
+
+    if (event->head == 0)
+    {
+        event->signalled = 1;
+    }
+    else
+    {
+        unblockProc(waitRemoveHead(&event->head, &event->tail));
+    }
+
+    USLOSS_PsrSet(psr);
+}
+
+/*
+ * Signals a kernel event, waking every process waiting on it
+ * With no one waiting the event stays signalled until the next wait
+ *
+ * Parameters:
+ *   event - the event
+ *
+ * Returns: void
+ */
+void kernEventSignalAll(KernelEvent *event)
+{
+    unsigned int psr = USLOSS_PsrGet();
+    USLOSS_PsrSet(psr & ~USLOSS_PSR_CURRENT_INT);
+
+    if (event->head == 0)
+    {
+        event->signalled = 1;
+    }
+
+    // take the whole list first, since each woken process may run before the next is woken
+    int next = event->head;
+    event->head = 0;
+    event->tail = 0;
+    while (next != 0)
+    {
+        int pid = next;
+        next = waitNext[pid % MAXPROC];
+        unblockProc(pid);
+    }
+
+    USLOSS_PsrSet(psr);
+}
+
+/*
+ * Copies out the contention profile of every profiled kernel mutex
+ *
+ * Parameters:
+ *   entries - receives up to max profiles, in the order the mutexes were initialized
+ *   max - the number of entries the caller has room for
+ *   count - receives the number of profiles copied
+ *
+ * Returns:
+ *   int - returns 0 on success, -1 if invalid parameters are provided
+ */
+int kernLockStats(LockStatsEntry *entries, int max, int *count)
+{
+    if (entries == NULL || max < 0)
+    {
+        return -1;
+    }
+
+    unsigned int psr = USLOSS_PsrGet();
+    USLOSS_PsrSet(psr & ~USLOSS_PSR_CURRENT_INT);
+
+    int n = mutexProfiledCount < max ? mutexProfiledCount : max;
+    for (int i = 0; i < n; i++)
+    {
+        entries[i] = mutexProfiled[i]->stats;
+    }
+
+    USLOSS_PsrSet(psr);
+
+    *count = n;
     return 0;
-}
\ No newline at end of file
+}
+
+/*
+ * Prints the contention profile of every profiled kernel mutex to the console
+ *
+ * Returns: void
+ */
+void dumpLockStats(void)
+{
+    LockStatsEntry entries[MUTEX_MAX_PROFILED];
+    int count;
+
+    kernLockStats(entries, MUTEX_MAX_PROFILED, &count);
+
+    USLOSS_Console("%-16s %8s %9s %12s %8s %12s %8s\n", "lock", "acquired", "contended",
+                   "wait us", "max", "hold us", "max");
+    for (int i = 0; i < count; i++)
+    {
+        LockStatsEntry *e = &entries[i];
+        USLOSS_Console("%-16s %8d %9d %12lld %8d %12lld %8d\n", e->name, e->acquisitions,
+                       e->contended, e->waitTotal, e->waitMax, e->holdTotal, e->holdMax);
+    }
+}
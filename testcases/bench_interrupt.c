@@ -0,0 +1,96 @@
+/*  INTERRUPT OVERHEAD BENCHMARK
+    Times a fixed amount of user-mode work twice: once with the devices
+    idle, and once while four children keep all four terminals busy.
+    The busy run is slower by the time spent handling the terminal
+    interrupts, which is divided by the number of characters sent (one
+    transmit interrupt each) to give an overhead per interrupt.
+
+    Run it once as built and once with the phase 4 objects built with
+    -DDRIVERS_IN_INTERRUPT=1 to compare driver processes with drivers
+    that run in the interrupt.
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include <usloss.h>
+#include <usyscall.h>
+
+#include <phase1.h>
+#include <phase2.h>
+#include <phase3.h>
+#include <phase3_usermode.h>
+#include <phase4.h>
+#include <phase4_usermode.h>
+
+#define WORK       20000000
+#define LINES      20
+#define LINE_LEN   40
+
+char lines[USLOSS_TERM_UNITS][LINE_LEN + 1];
+volatile int sink;
+
+
+
+static int work(void)
+{
+    int start, end, i;
+
+    GetTimeofDay(&start);
+    for (i = 0; i < WORK; i++)
+        sink += i;
+    GetTimeofDay(&end);
+
+    return end - start;
+}
+
+static int Writer(char *arg)
+{
+    int unit = (int)(long)arg;
+    int i, len;
+
+    for (i = 0; i < LINES; i++)
+        TermWrite(lines[unit], LINE_LEN, unit, &len);
+
+    Terminate(0);
+}
+
+
+
+int start4(char *arg)
+{
+    Phase4Stats before, after;
+    int idle, busy, unit, pid, status, sent;
+    char name[16];
+
+    for (unit = 0; unit < USLOSS_TERM_UNITS; unit++)
+    {
+        memset(lines[unit], 'a' + unit, LINE_LEN - 1);
+        lines[unit][LINE_LEN - 1] = '\n';
+        lines[unit][LINE_LEN] = '\0';
+    }
+
+    idle = work();
+
+    // the writers run at a higher priority, so the work only runs while they wait for the terminals
+    GetPhase4Stats(&before);
+    for (unit = 0; unit < USLOSS_TERM_UNITS; unit++)
+    {
+        sprintf(name, "Writer%d", unit);
+        Spawn(name, Writer, (char *)(long)unit, USLOSS_MIN_STACK, 2, &pid);
+    }
+    busy = work();
+    for (unit = 0; unit < USLOSS_TERM_UNITS; unit++)
+        Wait(&pid, &status);
+    GetPhase4Stats(&after);
+
+    sent = 0;
+    for (unit = 0; unit < USLOSS_TERM_UNITS; unit++)
+        sent += after.term[unit].charsOut - before.term[unit].charsOut;
+
+    USLOSS_Console("bench_interrupt: work idle %8d us   busy %8d us\n", idle, busy);
+    USLOSS_Console("bench_interrupt: %d characters sent, %d us of overhead per interrupt\n",
+                   sent, sent > 0 ? (busy - idle) / sent : 0);
+
+    Terminate(0);
+}
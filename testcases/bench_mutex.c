@@ -0,0 +1,167 @@
+/*  MUTEX BENCHMARK
+    Compares the kernel mutex with the mailbox lock it replaced.  The
+    loops have to run in kernel mode, so the benchmark installs its own
+    handler in an unused system call slot and runs each loop inside one
+    call.
+
+    Uncontended: one process acquires and releases the lock repeatedly.
+    Contended: start4 takes the lock and then wakes a higher-priority
+    waiter, which blocks on the lock.  start4 then releases the lock and
+    hands it to the waiter.  Each round therefore costs one contended
+    acquire and one handoff, along with the same wakeup in both variants.
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include <usloss.h>
+#include <usyscall.h>
+
+#include <phase1.h>
+#include <phase2.h>
+#include <phase3.h>
+#include <phase3_usermode.h>
+#include <phase4.h>
+#include <phase4_usermode.h>
+
+#define BENCH_SYSCALL   (MAXSYSCALLS - 1)
+#define ROUNDS          2000
+
+#define MODE_SETUP      0
+#define MODE_SOLO       1
+#define MODE_HOLDER     2
+#define MODE_WAITER     3
+#define MODE_DUMP       4
+
+#define KIND_MUTEX      0
+#define KIND_MAILBOX    1
+
+KernelMutex mutex;
+int mailboxLock;
+int kick;
+
+
+/* the mailbox lock the kernel used before KernelMutex: a one-slot
+ * mailbox that is full while the lock is held */
+static void lock(int lockId)
+{
+    MboxSend(lockId, NULL, 0);
+}
+
+static void unlock(int lockId)
+{
+    MboxRecv(lockId, NULL, 0);
+}
+
+
+static void acquire(int kind)
+{
+    if (kind == KIND_MUTEX)
+        kernMutexLock(&mutex);
+    else
+        lock(mailboxLock);
+}
+
+static void release(int kind)
+{
+    if (kind == KIND_MUTEX)
+        kernMutexUnlock(&mutex);
+    else
+        unlock(mailboxLock);
+}
+
+static void benchHandler(USLOSS_Sysargs *args)
+{
+    int mode = (int)(long)args->arg1;
+    int kind = (int)(long)args->arg2;
+    int start = currentTime();
+    int i;
+
+    switch (mode)
+    {
+    case MODE_SETUP:
+        kernMutexInit(&mutex, "bench");
+        mailboxLock = MboxCreate(1, 0);
+        kick = MboxCreate(1, 0);
+        break;
+    case MODE_SOLO:
+        for (i = 0; i < ROUNDS; i++)
+        {
+            acquire(kind);
+            release(kind);
+        }
+        break;
+    case MODE_HOLDER:
+        for (i = 0; i < ROUNDS; i++)
+        {
+            acquire(kind);
+            MboxSend(kick, NULL, 0);
+            release(kind);
+        }
+        break;
+    case MODE_WAITER:
+        for (i = 0; i < ROUNDS; i++)
+        {
+            MboxRecv(kick, NULL, 0);
+            acquire(kind);
+            release(kind);
+        }
+        break;
+    case MODE_DUMP:
+        dumpLockStats();
+        break;
+    }
+
+    args->arg4 = (void *)(long)(currentTime() - start);
+}
+
+static int run(int mode, int kind)
+{
+    USLOSS_Sysargs args;
+
+    args.number = BENCH_SYSCALL;
+    args.arg1 = (void *)(long)mode;
+    args.arg2 = (void *)(long)kind;
+    USLOSS_Syscall(&args);
+    return (int)(long)args.arg4;
+}
+
+static int waiter(char *arg)
+{
+    run(MODE_WAITER, arg[0] - '0');
+    Terminate(0);
+}
+
+static int contended(int kind)
+{
+    int pid, status, elapsed;
+
+    Spawn("waiter", waiter, kind == KIND_MUTEX ? "0" : "1", USLOSS_MIN_STACK, 2, &pid);
+    elapsed = run(MODE_HOLDER, kind);
+    Wait(&pid, &status);
+    return elapsed;
+}
+
+
+
+int start4(char *arg)
+{
+    int mutexTime, mailboxTime;
+
+    systemCallVec[BENCH_SYSCALL] = benchHandler;
+    run(MODE_SETUP, 0);
+
+    USLOSS_Console("bench_mutex: %d rounds\n", ROUNDS);
+
+    mutexTime = run(MODE_SOLO, KIND_MUTEX);
+    mailboxTime = run(MODE_SOLO, KIND_MAILBOX);
+    USLOSS_Console("bench_mutex: uncontended  mutex %8d us   mailbox %8d us\n", mutexTime, mailboxTime);
+
+    mutexTime = contended(KIND_MUTEX);
+    mailboxTime = contended(KIND_MAILBOX);
+    USLOSS_Console("bench_mutex: contended    mutex %8d us   mailbox %8d us\n", mutexTime, mailboxTime);
+
+    run(MODE_DUMP, 0);
+
+    Terminate(0);
+}
@@ -0,0 +1,67 @@
+/*  STRIPING BENCHMARK
+    Sequential throughput of disk 0 alone against the RAID-0 volume
+    striped across disk 0 and disk 1.  The same number of sectors is
+    written and then read back on each, in track-sized-or-larger chunks,
+    and the elapsed time of each phase is reported.
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include <usloss.h>
+#include <usyscall.h>
+
+#include <phase1.h>
+#include <phase2.h>
+#include <phase3.h>
+#include <phase3_usermode.h>
+#include <phase4.h>
+#include <phase4_usermode.h>
+
+#define CHUNK 32                 // sectors per call
+#define TOTAL (8 * 16)           // sectors per phase, half of disk 0
+
+char buf[CHUNK * 512];
+
+
+
+static int run(int unit, int write)
+{
+    int start, end, status, lba;
+
+    GetTimeofDay(&start);
+    for (lba = 0; lba < TOTAL; lba += CHUNK)
+    {
+        if (write)
+            DiskWriteBlocks(buf, unit, lba, CHUNK, &status);
+        else
+            DiskReadBlocks(buf, unit, lba, CHUNK, &status);
+
+        if (status != 0)
+            USLOSS_Console("run(): unit %d lba %d failed with status %d\n", unit, lba, status);
+    }
+    GetTimeofDay(&end);
+
+    return end - start;
+}
+
+
+
+int start4(char *arg)
+{
+    int single, striped;
+
+    memset(buf, 'x', sizeof(buf));
+
+    USLOSS_Console("bench_stripe: %d sectors in %d-sector calls\n", TOTAL, CHUNK);
+
+    single = run(0, 1);
+    striped = run(DISK_UNIT_STRIPED, 1);
+    USLOSS_Console("bench_stripe: write  disk0 %8d us   striped %8d us\n", single, striped);
+
+    single = run(0, 0);
+    striped = run(DISK_UNIT_STRIPED, 0);
+    USLOSS_Console("bench_stripe: read   disk0 %8d us   striped %8d us\n", single, striped);
+
+    Terminate(0);
+}
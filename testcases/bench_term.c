@@ -0,0 +1,78 @@
+/*  TERMINAL THROUGHPUT BENCHMARK
+    Four children each write the same number of lines to their own
+    terminal at once, and the aggregate rate is reported along with the
+    time until the last child finished.
+
+    Run it once as built and once with the phase 4 objects built with
+    -DTERM_EVENT_LOOP=1 to compare a driver process per terminal unit
+    with the single terminal service process.
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include <usloss.h>
+#include <usyscall.h>
+
+#include <phase1.h>
+#include <phase2.h>
+#include <phase3.h>
+#include <phase3_usermode.h>
+#include <phase4.h>
+#include <phase4_usermode.h>
+
+#define LINES      20
+#define LINE_LEN   40
+
+char lines[USLOSS_TERM_UNITS][LINE_LEN + 1];
+
+
+
+static int Writer(char *arg)
+{
+    int unit = (int)(long)arg;
+    int i, len;
+
+    for (i = 0; i < LINES; i++)
+    {
+        TermWrite(lines[unit], LINE_LEN, unit, &len);
+        if (len != LINE_LEN)
+            USLOSS_Console("Writer(): term%d wrote %d of %d characters\n", unit, len, LINE_LEN);
+    }
+
+    Terminate(0);
+}
+
+
+
+int start4(char *arg)
+{
+    int start, end, unit, pid, status;
+    char name[16];
+
+    for (unit = 0; unit < USLOSS_TERM_UNITS; unit++)
+    {
+        memset(lines[unit], 'a' + unit, LINE_LEN - 1);
+        lines[unit][LINE_LEN - 1] = '\n';
+        lines[unit][LINE_LEN] = '\0';
+    }
+
+    USLOSS_Console("bench_term: %d lines of %d characters to each of %d terminals\n",
+                   LINES, LINE_LEN, USLOSS_TERM_UNITS);
+
+    GetTimeofDay(&start);
+    for (unit = 0; unit < USLOSS_TERM_UNITS; unit++)
+    {
+        sprintf(name, "Writer%d", unit);
+        Spawn(name, Writer, (char *)(long)unit, USLOSS_MIN_STACK, 3, &pid);
+    }
+    for (unit = 0; unit < USLOSS_TERM_UNITS; unit++)
+        Wait(&pid, &status);
+    GetTimeofDay(&end);
+
+    int chars = LINES * LINE_LEN * USLOSS_TERM_UNITS;
+    USLOSS_Console("bench_term: %d characters in %d us, %d characters per second\n",
+                   chars, end - start, (int)((long long)chars * 1000000 / (end - start)));
+
+    Terminate(0);
+}
@@ -0,0 +1,84 @@
+/*  WHOLE-TRACK BENCHMARK
+    Writes and then reads the same 8 tracks of disk 1 twice: once as
+    whole-track transfers starting at sector 0, which take the driver's
+    aligned-track fast path, and once a sector at a time.  The elapsed
+    time of each phase is reported.
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include <usloss.h>
+#include <usyscall.h>
+
+#include <phase1.h>
+#include <phase2.h>
+#include <phase3.h>
+#include <phase3_usermode.h>
+#include <phase4.h>
+#include <phase4_usermode.h>
+
+#define TRACKS 8
+
+char buf[TRACKS * 16 * 512];
+
+
+
+static int whole(int write)
+{
+    int start, end, status;
+
+    GetTimeofDay(&start);
+    if (write)
+        DiskWrite(buf, 1, 0, 0, TRACKS * 16, &status);
+    else
+        DiskRead(buf, 1, 0, 0, TRACKS * 16, &status);
+    GetTimeofDay(&end);
+
+    if (status != 0)
+        USLOSS_Console("whole(): failed with status %d\n", status);
+    return end - start;
+}
+
+static int bySector(int write)
+{
+    int start, end, status, track, sector;
+
+    GetTimeofDay(&start);
+    for (track = 0; track < TRACKS; track++)
+        for (sector = 0; sector < 16; sector++)
+        {
+            char *p = buf + (track * 16 + sector) * 512;
+            if (write)
+                DiskWrite(p, 1, track, sector, 1, &status);
+            else
+                DiskRead(p, 1, track, sector, 1, &status);
+
+            if (status != 0)
+                USLOSS_Console("bySector(): track %d sector %d failed with status %d\n", track, sector, status);
+        }
+    GetTimeofDay(&end);
+
+    return end - start;
+}
+
+
+
+int start4(char *arg)
+{
+    int fast, slow;
+
+    memset(buf, 't', sizeof(buf));
+
+    USLOSS_Console("bench_track: %d tracks of disk 1\n", TRACKS);
+
+    fast = whole(1);
+    slow = bySector(1);
+    USLOSS_Console("bench_track: write  whole-track %8d us   by sector %8d us\n", fast, slow);
+
+    fast = whole(0);
+    slow = bySector(0);
+    USLOSS_Console("bench_track: read   whole-track %8d us   by sector %8d us\n", fast, slow);
+
+    Terminate(0);
+}
@@ -0,0 +1,77 @@
+/*  ASYNC DISKTEST
+    Queue writes on both disks without waiting for them, collect them
+    with DiskWaitAny(), then read the sectors back asynchronously and
+    wait for each handle in turn.  A ninth outstanding request from the
+    same process must be refused.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include <usloss.h>
+#include <usyscall.h>
+
+#include <phase1.h>
+#include <phase2.h>
+#include <phase3.h>
+#include <phase3_usermode.h>
+#include <phase4.h>
+#include <phase4_usermode.h>
+
+#define NUM_REQS 8
+
+char sectors[NUM_REQS][512];
+char copy[NUM_REQS][512];
+
+
+
+int start4(char *arg)
+{
+    int handles[NUM_REQS];
+    int result;
+    int status;
+    int handle;
+    int i;
+
+    USLOSS_Console("start4(): Queueing %d writes across both disks\n", NUM_REQS);
+    for (i = 0; i < NUM_REQS; i++)
+    {
+        sprintf(sectors[i], "async sector %d", i);
+        result = DiskWriteAsync(sectors[i], i % 2, 9 - i, i, 1, &handles[i]);
+        assert(result == 0);
+    }
+
+    result = DiskWriteAsync(sectors[0], 0, 0, 0, 1, &handle);
+    USLOSS_Console("start4(): Ninth outstanding request returned %d\n", result);
+
+    for (i = 0; i < NUM_REQS; i++)
+    {
+        result = DiskWaitAny(&handle, &status);
+        assert(result == 0);
+        assert(status == 0);
+    }
+
+    result = DiskWaitAny(&handle, &status);
+    USLOSS_Console("start4(): DiskWaitAny() with nothing outstanding returned %d\n", result);
+
+    USLOSS_Console("start4(): Reading the sectors back\n");
+    for (i = 0; i < NUM_REQS; i++)
+    {
+        result = DiskReadAsync(copy[i], i % 2, 9 - i, i, 1, &handles[i]);
+        assert(result == 0);
+    }
+
+    for (i = NUM_REQS - 1; i >= 0; i--)
+    {
+        result = DiskWait(handles[i], &status);
+        assert(result == 0);
+        assert(status == 0);
+    }
+
+    for (i = 0; i < NUM_REQS; i++)
+        USLOSS_Console("start4(): Read from disk: '%s'\n", copy[i]);
+
+    USLOSS_Console("start4(): Terminating\n");
+    Terminate(0);
+}
@@ -0,0 +1,69 @@
+/*  VECTORED DISKTEST
+    Write four sectors, wrapping to the next track, from three separate
+    buffers with DiskWritev(), then read them back with DiskReadv() into
+    a differently-shaped set of buffers.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include <usloss.h>
+#include <usyscall.h>
+
+#include <phase1.h>
+#include <phase2.h>
+#include <phase3.h>
+#include <phase3_usermode.h>
+#include <phase4.h>
+#include <phase4_usermode.h>
+
+char header[512];
+char body[2 * 512];
+char trailer[512];
+
+char copyA[3 * 512];
+char copyB[512];
+
+
+
+int start4(char *arg)
+{
+    DiskIovec out[3];
+    DiskIovec in[2];
+    int result;
+    int status;
+
+    strcpy(header, "header sector");
+    strcpy(&body[0 * 512], "first body sector");
+    strcpy(&body[1 * 512], "second body sector");
+    strcpy(trailer, "trailer sector");
+
+    out[0].buffer = header;  out[0].sectors = 1;
+    out[1].buffer = body;    out[1].sectors = 2;
+    out[2].buffer = trailer; out[2].sectors = 1;
+
+    USLOSS_Console("start4(): Writing 3 fragments to disk 1, track 6, sector 14\n");
+    result = DiskWritev(out, 3, 1, 6, 14, &status);
+    assert(result == 0);
+    assert(status == 0);
+
+    in[0].buffer = copyA; in[0].sectors = 3;
+    in[1].buffer = copyB; in[1].sectors = 1;
+
+    result = DiskReadv(in, 2, 1, 6, 14, &status);
+    assert(result == 0);
+    assert(status == 0);
+
+    USLOSS_Console("start4(): Read from disk: '%s'\n", &copyA[0 * 512]);
+    USLOSS_Console("start4(): Read from disk: '%s'\n", &copyA[1 * 512]);
+    USLOSS_Console("start4(): Read from disk: '%s'\n", &copyA[2 * 512]);
+    USLOSS_Console("start4(): Read from disk: '%s'\n", copyB);
+
+    in[1].sectors = 0;
+    result = DiskReadv(in, 2, 1, 6, 14, &status);
+    USLOSS_Console("start4(): Empty fragment returned %d\n", result);
+
+    USLOSS_Console("start4(): Terminating\n");
+    Terminate(0);
+}
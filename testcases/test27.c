@@ -0,0 +1,63 @@
+/*  LBA DISKTEST
+    Write 20 logical sectors starting at LBA 10 on disk 0, which spans
+    tracks 0 through 1, read them back with DiskReadBlocks(), and check
+    the track/sector mapping with an ordinary DiskRead().  A run past the
+    end of the disk must be rejected.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include <usloss.h>
+#include <usyscall.h>
+
+#include <phase1.h>
+#include <phase2.h>
+#include <phase3.h>
+#include <phase3_usermode.h>
+#include <phase4.h>
+#include <phase4_usermode.h>
+
+#define COUNT 20
+
+char blocks[COUNT][512];
+char copy[COUNT][512];
+char single[512];
+
+
+
+int start4(char *arg)
+{
+    int sectorSize, trackSize, diskSize;
+    int result;
+    int status;
+    int i;
+
+    DiskSize(0, &sectorSize, &trackSize, &diskSize);
+
+    for (i = 0; i < COUNT; i++)
+        sprintf(blocks[i], "logical block %d", 10 + i);
+
+    USLOSS_Console("start4(): Writing %d blocks at LBA 10 on disk 0\n", COUNT);
+    result = DiskWriteBlocks(blocks, 0, 10, COUNT, &status);
+    assert(result == 0);
+    assert(status == 0);
+
+    result = DiskReadBlocks(copy, 0, 10, COUNT, &status);
+    assert(result == 0);
+    assert(status == 0);
+    USLOSS_Console("start4(): Read from disk: '%s'\n", copy[0]);
+    USLOSS_Console("start4(): Read from disk: '%s'\n", copy[COUNT - 1]);
+
+    result = DiskRead(single, 0, 1, 2, 1, &status);
+    assert(result == 0);
+    assert(status == 0);
+    USLOSS_Console("start4(): Track 1 sector 2 holds: '%s'\n", single);
+
+    result = DiskReadBlocks(copy, 0, diskSize * trackSize - 5, 10, &status);
+    USLOSS_Console("start4(): Run past the end of the disk returned %d\n", result);
+
+    USLOSS_Console("start4(): Terminating\n");
+    Terminate(0);
+}
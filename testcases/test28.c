@@ -0,0 +1,74 @@
+/*  ZERO DISKTEST
+    Write 20 logical sectors at LBA 4 on disk 0, copy them to LBA 40 on
+    disk 1 with DiskCopy(), then wipe the middle of the copy with
+    DiskZero().  Sectors on either side of the wiped range must keep
+    the copied data, and a range past the end of the disk must be
+    rejected with -1, as DiskReadBlocks() and DiskCopy() reject one.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include <usloss.h>
+#include <usyscall.h>
+
+#include <phase1.h>
+#include <phase2.h>
+#include <phase3.h>
+#include <phase3_usermode.h>
+#include <phase4.h>
+#include <phase4_usermode.h>
+
+#define COUNT 20
+
+char blocks[COUNT][512];
+char copy[COUNT][512];
+
+
+
+int start4(char *arg)
+{
+    int sectorSize, trackSize, diskSize;
+    int result;
+    int status;
+    int i, zeroed;
+
+    DiskSize(1, &sectorSize, &trackSize, &diskSize);
+
+    for (i = 0; i < COUNT; i++)
+        sprintf(blocks[i], "copied block %d", i);
+
+    USLOSS_Console("start4(): Copying %d blocks from disk 0 to disk 1\n", COUNT);
+    result = DiskWriteBlocks(blocks, 0, 4, COUNT, &status);
+    assert(result == 0);
+    assert(status == 0);
+
+    result = DiskCopy(0, 4, 1, 40, COUNT, &status);
+    assert(result == 0);
+    assert(status == 0);
+
+    /* LBA 45 through 58 is track 2 sector 13 through track 3 sector 10 */
+    USLOSS_Console("start4(): Zeroing 14 sectors from track 2 sector 13 on disk 1\n");
+    result = DiskZero(1, 2, 13, 14, &status);
+    assert(result == 0);
+    assert(status == 0);
+
+    result = DiskReadBlocks(copy, 1, 40, COUNT, &status);
+    assert(result == 0);
+    assert(status == 0);
+
+    zeroed = 0;
+    for (i = 0; i < COUNT; i++)
+        if (copy[i][0] == '\0')
+            zeroed++;
+    USLOSS_Console("start4(): %d of %d sectors read back as zero\n", zeroed, COUNT);
+    USLOSS_Console("start4(): Read from disk: '%s'\n", copy[4]);
+    USLOSS_Console("start4(): Read from disk: '%s'\n", copy[19]);
+
+    result = DiskZero(1, diskSize - 1, 10, 10, &status);
+    USLOSS_Console("start4(): Zeroing past the end of the disk returned %d\n", result);
+
+    USLOSS_Console("start4(): Terminating\n");
+    Terminate(0);
+}
@@ -0,0 +1,70 @@
+/*  ADVISE DISKTEST
+    Mark tracks 4 and 5 of disk 1 as RANDOM so reads of them are cached.
+    A second read of the same sectors must be answered from the cache, a
+    write must make the next read go back to the disk and see the new
+    data, and DONTNEED must drop the range again.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include <usloss.h>
+#include <usyscall.h>
+
+#include <phase1.h>
+#include <phase2.h>
+#include <phase3.h>
+#include <phase3_usermode.h>
+#include <phase4.h>
+#include <phase4_usermode.h>
+
+char sectors[3][512];
+char copy[3][512];
+
+int hits(void)
+{
+    DiskUnitStats stats;
+
+    DiskStats(1, &stats);
+    return stats.cacheHits;
+}
+
+int start4(char *arg)
+{
+    int result;
+    int status;
+    int i;
+
+    for (i = 0; i < 3; i++)
+        sprintf(sectors[i], "advised sector %d", i);
+
+    result = DiskWrite(sectors, 1, 4, 7, 3, &status);
+    assert(result == 0);
+    assert(status == 0);
+
+    result = DiskAdvise(1, 4, 2, DISK_ADVICE_RANDOM);
+    USLOSS_Console("start4(): DiskAdvise RANDOM returned %d\n", result);
+
+    DiskRead(copy, 1, 4, 7, 3, &status);
+    DiskRead(copy, 1, 4, 7, 3, &status);
+    USLOSS_Console("start4(): Read twice: '%s', cache hits %d\n", copy[2], hits());
+
+    sprintf(sectors[2], "rewritten sector 2");
+    DiskWrite(sectors[2], 1, 4, 9, 1, &status);
+    DiskRead(copy, 1, 4, 7, 3, &status);
+    USLOSS_Console("start4(): Read after write: '%s', cache hits %d\n", copy[2], hits());
+
+    DiskRead(copy, 1, 4, 7, 3, &status);
+    USLOSS_Console("start4(): Read again: '%s', cache hits %d\n", copy[2], hits());
+
+    DiskAdvise(1, 4, 2, DISK_ADVICE_DONTNEED);
+    DiskRead(copy, 1, 4, 7, 3, &status);
+    USLOSS_Console("start4(): Read after DONTNEED: '%s', cache hits %d\n", copy[2], hits());
+
+    result = DiskAdvise(1, 30, 4, DISK_ADVICE_WILLNEED);
+    USLOSS_Console("start4(): Advice past the end of the disk returned %d\n", result);
+
+    USLOSS_Console("start4(): Terminating\n");
+    Terminate(0);
+}
@@ -0,0 +1,63 @@
+/*  DISK SHARE TEST
+    Cap this process at 16 sectors per second with DiskSetShare() and write
+    two tracks to disk 1 in one call, which overdraws the full token bucket.
+    The next write and a following read each have to wait for clock
+    ticks to refill it.  DiskProcStats() must report the share, the cap, the bytes moved
+    and the two throttled requests.  An out-of-range share is rejected.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include <usloss.h>
+#include <usyscall.h>
+
+#include <phase1.h>
+#include <phase2.h>
+#include <phase3.h>
+#include <phase3_usermode.h>
+#include <phase4.h>
+#include <phase4_usermode.h>
+
+char tracks[32][512];
+
+
+
+int start4(char *arg)
+{
+    DiskProcCounters counters;
+    int result;
+    int status;
+
+    result = DiskSetShare(-1, DISK_MAX_SHARE + 1, 0);
+    USLOSS_Console("start4(): DiskSetShare with share %d returned %d\n", DISK_MAX_SHARE + 1, result);
+
+    result = DiskSetShare(-1, 200, 16);
+    assert(result == 0);
+
+    USLOSS_Console("start4(): Writing 3 tracks to disk 1 at 16 sectors per second\n");
+    sprintf(tracks[0], "capped track 10");
+    sprintf(tracks[16], "capped track 11");
+    result = DiskWrite(tracks, 1, 10, 0, 32, &status);
+    assert(result == 0);
+    assert(status == 0);
+    sprintf(tracks[0], "capped track 12");
+    result = DiskWrite(tracks, 1, 12, 0, 16, &status);
+    assert(result == 0);
+    assert(status == 0);
+
+    result = DiskRead(tracks, 1, 11, 0, 16, &status);
+    assert(result == 0);
+    USLOSS_Console("start4(): Read from disk: '%s'\n", tracks[0]);
+
+    DiskProcStats(-1, &counters);
+    USLOSS_Console("start4(): share %d, cap %d, read %lld bytes, wrote %lld bytes, throttled %d\n",
+                   counters.share, counters.rateCap, counters.bytesRead,
+                   counters.bytesWritten, counters.throttled);
+
+    DiskSetShare(-1, DISK_DEFAULT_SHARE, 0);
+
+    USLOSS_Console("start4(): Terminating\n");
+    Terminate(0);
+}
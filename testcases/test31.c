@@ -0,0 +1,94 @@
+/*  BATCH TEST
+    Write a sector to each disk and sleep for a second with one
+    Phase4Submit() call, then read both sectors back with a second batch.
+    Every operation must report a completion.  An unknown opcode completes
+    with a result of -1 without stopping the rest of the batch, and so
+    does a disk write the device fails.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include <usloss.h>
+#include <usyscall.h>
+
+#include <phase1.h>
+#include <phase2.h>
+#include <phase3.h>
+#include <phase3_usermode.h>
+#include <phase4.h>
+#include <phase4_usermode.h>
+
+char sectors[2][512];
+char copy[2][512];
+
+Phase4Op ops[3];
+Phase4Completion completions[3];
+
+void report(int completed)
+{
+    int i, j;
+
+    /* completions arrive in finishing order, so print them in submission order */
+    for (i = 0; i < 3; i++)
+        for (j = 0; j < completed; j++)
+            if (completions[j].index == i)
+                USLOSS_Console("start4(): op %d: result %d, status %d\n",
+                               i, completions[j].result, completions[j].status);
+}
+
+int start4(char *arg)
+{
+    int result;
+    int completed;
+    int i;
+
+    for (i = 0; i < 2; i++)
+    {
+        sprintf(sectors[i], "batched sector on disk %d", i);
+        ops[i].opcode = PHASE4_OP_DISKWRITE;
+        ops[i].buffer = sectors[i];
+        ops[i].unit = i;
+        ops[i].track = 3;
+        ops[i].first = 4;
+        ops[i].count = 1;
+    }
+    ops[2].opcode = PHASE4_OP_SLEEP;
+    ops[2].count = 1;
+
+    USLOSS_Console("start4(): Submitting two disk writes and a sleep\n");
+    result = Phase4Submit(ops, 3, completions, &completed);
+    USLOSS_Console("start4(): Phase4Submit returned %d with %d completions\n", result, completed);
+    report(completed);
+
+    for (i = 0; i < 2; i++)
+    {
+        ops[i].opcode = PHASE4_OP_DISKREAD;
+        ops[i].buffer = copy[i];
+    }
+    ops[2].opcode = 99;
+
+    USLOSS_Console("start4(): Submitting two disk reads and an unknown opcode\n");
+    result = Phase4Submit(ops, 3, completions, &completed);
+    USLOSS_Console("start4(): Phase4Submit returned %d with %d completions\n", result, completed);
+    report(completed);
+    USLOSS_Console("start4(): Read from disk: '%s'\n", copy[0]);
+    USLOSS_Console("start4(): Read from disk: '%s'\n", copy[1]);
+
+    ops[0].opcode = PHASE4_OP_DISKWRITE;
+    ops[0].buffer = sectors[0];
+    ops[0].track = 1776;
+
+    USLOSS_Console("start4(): Submitting a disk write past the end of the disk\n");
+    result = Phase4Submit(ops, 1, completions, &completed);
+    USLOSS_Console("start4(): Phase4Submit returned %d with %d completions\n", result, completed);
+    USLOSS_Console("start4(): op 0: result %d, status %d\n",
+                   completions[0].result, completions[0].status);
+
+    result = Phase4Submit(ops, PHASE4_BATCH_MAX + 1, completions, &completed);
+    USLOSS_Console("start4(): Oversized batch returned %d\n", result);
+
+    USLOSS_Console("start4(): Terminating\n");
+    Terminate(0);
+}
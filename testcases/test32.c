@@ -0,0 +1,63 @@
+/*  LOCK STATS TEST
+    List the phase 4 kernel locks reported by LockStats() and check that
+    a disk write and a terminal write each count acquisitions of their
+    locks.  A call with room for only two entries reports two.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include <usloss.h>
+#include <usyscall.h>
+
+#include <phase1.h>
+#include <phase2.h>
+#include <phase3.h>
+#include <phase3_usermode.h>
+#include <phase4.h>
+#include <phase4_usermode.h>
+
+#define MAX_LOCKS 16
+
+LockStatsEntry entries[MAX_LOCKS];
+char sector[512];
+
+int acquisitions(char *name)
+{
+    int count, i;
+
+    LockStats(entries, MAX_LOCKS, &count);
+    for (i = 0; i < count; i++)
+        if (strcmp(entries[i].name, name) == 0)
+            return entries[i].acquisitions;
+    return -1;
+}
+
+int start4(char *arg)
+{
+    int result, count, status, len;
+    int before;
+    int i;
+
+    result = LockStats(entries, MAX_LOCKS, &count);
+    assert(result == 0);
+    for (i = 0; i < count; i++)
+        USLOSS_Console("start4(): lock '%s'\n", entries[i].name);
+
+    before = acquisitions("disk");
+    strcpy(sector, "locked sector");
+    DiskWrite(sector, 0, 2, 0, 1, &status);
+    USLOSS_Console("start4(): disk lock taken after a write: %d\n", acquisitions("disk") > before);
+
+    before = acquisitions("termWrite1");
+    TermWrite("locked line\n", 12, 1, &len);
+    USLOSS_Console("start4(): termWrite1 acquisitions added by a write: %d\n",
+                   acquisitions("termWrite1") - before);
+
+    result = LockStats(entries, 2, &count);
+    USLOSS_Console("start4(): LockStats with room for 2 returned %d, count %d\n", result, count);
+
+    USLOSS_Console("start4(): Terminating\n");
+    Terminate(0);
+}
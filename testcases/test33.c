@@ -0,0 +1,64 @@
+/*  PHASE 4 STATS TEST
+    Take GetPhase4Stats() snapshots around a sleeping child, a terminal
+    write and a disk write, and check that each one moves the counters it
+    should.  The sleeper count drops back to 0 once the child wakes up.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include <usloss.h>
+#include <usyscall.h>
+
+#include <phase1.h>
+#include <phase2.h>
+#include <phase3.h>
+#include <phase3_usermode.h>
+#include <phase4.h>
+#include <phase4_usermode.h>
+
+Phase4Stats before, after;
+char sector[512];
+
+int Sleeper(char *arg)
+{
+    Sleep(2);
+    Terminate(0);
+}
+
+int start4(char *arg)
+{
+    int result, pid, status, len;
+
+    result = GetPhase4Stats(&before);
+    assert(result == 0);
+    USLOSS_Console("start4(): version %d, size matches %d, sleepers %d\n",
+                   before.version, before.size == sizeof(Phase4Stats), before.sleepers);
+
+    Spawn("Sleeper", Sleeper, NULL, USLOSS_MIN_STACK, 3, &pid);
+    Sleep(1);
+    GetPhase4Stats(&after);
+    USLOSS_Console("start4(): sleepers while the child sleeps %d, clock ticked %d\n",
+                   after.sleepers, after.clockTicks > before.clockTicks);
+    Wait(&pid, &status);
+
+    GetPhase4Stats(&before);
+    TermWrite("stats line\n", 11, 2, &len);
+    strcpy(sector, "counted sector");
+    DiskWrite(sector, 1, 3, 0, 1, &status);
+    GetPhase4Stats(&after);
+
+    USLOSS_Console("start4(): sleepers after the child woke %d\n", after.sleepers);
+    USLOSS_Console("start4(): term2 chars out added %d\n",
+                   after.term[2].charsOut - before.term[2].charsOut);
+    USLOSS_Console("start4(): disk1 ops added %d, sectors added %d\n",
+                   after.disk[1].ops - before.disk[1].ops,
+                   after.disk[1].sectors - before.disk[1].sectors);
+
+    result = GetPhase4Stats(NULL);
+    USLOSS_Console("start4(): GetPhase4Stats(NULL) returned %d\n", result);
+
+    USLOSS_Console("start4(): Terminating\n");
+    Terminate(0);
+}
@@ -0,0 +1,48 @@
+/*  DISK END TEST
+    Write the last sector DiskSize() reports, then try a write to the track
+    just past it and a write that starts on the last track and runs over its
+    end.  Neither may reach the device: both come back with an OK return
+    value and a USLOSS_DEV_ERROR status, as a track past the end of the
+    device does, and the last sector still holds what was written to it.
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include <usloss.h>
+#include <usyscall.h>
+
+#include <phase1.h>
+#include <phase2.h>
+#include <phase3.h>
+#include <phase3_usermode.h>
+#include <phase4.h>
+#include <phase4_usermode.h>
+
+char last[512];
+char other[1024];
+char copy[512];
+
+int start4(char *arg)
+{
+    int result, status, sectorSize, trackSize, tracks;
+
+    DiskSize(1, &sectorSize, &trackSize, &tracks);
+
+    strcpy(last, "last visible sector");
+    result = DiskWrite(last, 1, tracks - 1, trackSize - 1, 1, &status);
+    USLOSS_Console("start4(): last sector:   result %d, status %d\n", result, status);
+
+    memset(other, 'x', sizeof(other));
+    result = DiskWrite(other, 1, tracks, 0, 1, &status);
+    USLOSS_Console("start4(): track past it: result %d, status %d\n", result, status);
+
+    result = DiskWrite(other, 1, tracks - 1, trackSize - 1, 2, &status);
+    USLOSS_Console("start4(): run over end:  result %d, status %d\n", result, status);
+
+    result = DiskRead(copy, 1, tracks - 1, trackSize - 1, 1, &status);
+    USLOSS_Console("start4(): read back:     result %d, status %d, '%s'\n", result, status, copy);
+
+    USLOSS_Console("start4(): Terminating\n");
+    Terminate(0);
+}
@@ -0,0 +1,90 @@
+/*  DISK ORDER TEST
+    Keep disk 1's driver busy, then queue a whole-track write and a
+    one-sector read of the same track behind it.  The read is cheaper,
+    but it was issued after the write, so it must see the written data.
+    Then queue a long write and a short write that overlap each other
+    but are too long together to share a device pass: the newer data
+    must be what is left on the overlapping sectors.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include <usloss.h>
+#include <usyscall.h>
+
+#include <phase1.h>
+#include <phase2.h>
+#include <phase3.h>
+#include <phase3_usermode.h>
+#include <phase4.h>
+#include <phase4_usermode.h>
+
+#define LONG_RUN 60
+
+char filler[16][512];
+char track5[16][512];
+char older[LONG_RUN][512];
+char newer[8][512];
+char copy[512];
+
+void waitAll(int *handles, int count)
+{
+    int i, result, status;
+
+    for (i = 0; i < count; i++)
+    {
+        result = DiskWait(handles[i], &status);
+        assert(result == 0);
+        assert(status == 0);
+    }
+}
+
+int start4(char *arg)
+{
+    int handles[3];
+    int result, status, i;
+
+    strcpy(copy, "stale sector");
+    result = DiskWrite(copy, 1, 5, 0, 1, &status);
+    assert(result == 0 && status == 0);
+
+    for (i = 0; i < 16; i++)
+        sprintf(track5[i], "written sector %d", i);
+
+    USLOSS_Console("start4(): Queueing a track write, then a read of its first sector\n");
+    result = DiskWriteAsync(filler, 1, 12, 0, 16, &handles[0]);
+    assert(result == 0);
+    result = DiskWriteAsync(track5, 1, 5, 0, 16, &handles[1]);
+    assert(result == 0);
+    result = DiskReadAsync(copy, 1, 5, 0, 1, &handles[2]);
+    assert(result == 0);
+    waitAll(handles, 3);
+    USLOSS_Console("start4(): Read from disk: '%s'\n", copy);
+
+    for (i = 0; i < LONG_RUN; i++)
+        sprintf(older[i], "older sector %d", i);
+    for (i = 0; i < 8; i++)
+        sprintf(newer[i], "newer sector %d", i);
+
+    USLOSS_Console("start4(): Queueing a %d-sector write, then an overlapping 8-sector write\n",
+                   LONG_RUN);
+    result = DiskWriteAsync(filler, 1, 12, 0, 16, &handles[0]);
+    assert(result == 0);
+    result = DiskWriteAsync(older, 1, 2, 0, LONG_RUN, &handles[1]);
+    assert(result == 0);
+    result = DiskWriteAsync(newer, 1, 5, 10, 8, &handles[2]);
+    assert(result == 0);
+    waitAll(handles, 3);
+
+    DiskRead(copy, 1, 5, 9, 1, &status);
+    USLOSS_Console("start4(): Read from disk: '%s'\n", copy);
+    DiskRead(copy, 1, 5, 10, 1, &status);
+    USLOSS_Console("start4(): Read from disk: '%s'\n", copy);
+    DiskRead(copy, 1, 5, 11, 1, &status);
+    USLOSS_Console("start4(): Read from disk: '%s'\n", copy);
+
+    USLOSS_Console("start4(): Terminating\n");
+    Terminate(0);
+}